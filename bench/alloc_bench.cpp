@@ -0,0 +1,76 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <tinystl/allocator>
+
+// Mimics worker threads which create and destroy short strings and vectors:
+// every round allocates a handful of small blocks and frees them again.
+template <class Policy>
+static void worker(int rounds)
+{
+    tinystd::allocator<char, Policy> alloc;
+    char *blocks[16];
+
+    for (int r=0; r < rounds; r++) {
+        for (int i=0; i < 16; i++) {
+            blocks[i] = alloc.allocate(16 + 16 * (i & 7));
+            blocks[i][0] = (char)i;
+        }
+        for (int i=0; i < 16; i++) {
+            alloc.deallocate(blocks[i], 16 + 16 * (i & 7));
+        }
+    }
+}
+
+template <class Policy>
+static double run(int threads, int rounds)
+{
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int t=0; t < threads; t++)
+        pool.push_back(std::thread(worker<Policy>, rounds));
+    for (auto &th: pool)
+        th.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return (double)threads * rounds * 16 / elapsed.count() / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = (argc > 1) ? atoi(argv[1]) : 100000;
+    int max_threads = (argc > 2) ? atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+
+    if (max_threads < 4)
+        max_threads = 4;
+
+    // The runtime column uses the backend selected by TINYSTD_ALLOC
+    printf("threads    base Mops/s  cached Mops/s  runtime Mops/s (%s)\n", alloc_backend_get()->name);
+    for (int t=1; t <= max_threads; t *= 2) {
+        double base = run<tinystd::base_policy>(t, rounds);
+        double cached = run<tinystd::cached_policy>(t, rounds);
+        double runtime = run<tinystd::runtime_policy>(t, rounds);
+        printf("%7d  %13.2f  %13.2f  %14.2f\n", t, base, cached, runtime);
+    }
+
+    struct tcache_stats stats;
+    tcache_get_stats(&stats);
+    printf("\ncache hits: %llu, misses: %llu, refills: %llu, drains: %llu\n",
+        (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+        (unsigned long long)stats.refills, (unsigned long long)stats.drains);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+#include <tinystl/charconv>
+
+// Parses a buffer of newline separated numbers with strtoull/strtod and with
+// from_chars and reports the throughput of both.
+
+template <class Fn>
+static double run(const std::vector<char>& text, int rounds, Fn fn)
+{
+    double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i=0; i < rounds; i++) {
+        const char *p = text.data();
+        const char *end = p + text.size();
+        while (p < end)
+            p = fn(p, end, sink) + 1;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (sink == 42)
+        printf(" ");
+    return (double)text.size() * rounds / elapsed.count() / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    int count = (argc > 1) ? atoi(argv[1]) : 100000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 20;
+
+    std::vector<char> integers, doubles;
+    uint64_t state = 88172645463325252ULL;
+    char buffer[64];
+    for (int i=0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int n = snprintf(buffer, sizeof(buffer), "%llu\n", (unsigned long long)(state >> (state % 50)));
+        integers.insert(integers.end(), buffer, buffer + n);
+        n = snprintf(buffer, sizeof(buffer), "%.17g\n", (double)(state >> 11) / (1ULL << 53) * 1000);
+        doubles.insert(doubles.end(), buffer, buffer + n);
+    }
+    integers.push_back(0);
+    doubles.push_back(0);
+
+    printf("parse                  libc MB/s  tinystd MB/s\n");
+    printf("integers           %13.1f  %12.1f\n",
+        run(integers, rounds, [](const char *p, const char *, double& sink) {
+            char *end;
+            sink += strtoull(p, &end, 10);
+            return (const char *)end;
+        }),
+        run(integers, rounds, [](const char *p, const char *last, double& sink) {
+            unsigned long long v = 0;
+            p = tinystd::from_chars(p, last, v).ptr;
+            sink += v;
+            return p;
+        }));
+    printf("doubles            %13.1f  %12.1f\n",
+        run(doubles, rounds, [](const char *p, const char *, double& sink) {
+            char *end;
+            sink += strtod(p, &end);
+            return (const char *)end;
+        }),
+        run(doubles, rounds, [](const char *p, const char *last, double& sink) {
+            double v = 0;
+            p = tinystd::from_chars(p, last, v).ptr;
+            sink += v;
+            return p;
+        }));
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <tinystl/bits/support.h>
+
+// Producer/consumer pipeline: every producer allocates small blocks (the size
+// of list nodes) and passes them through a ring to its consumer, which frees
+// them. With the slab allocator all of these frees are remote frees.
+
+static const int RING_SIZE = 1024;
+
+struct ring {
+    void               *slots[RING_SIZE];
+    std::atomic<int>    head;
+    char                pad[64];
+    std::atomic<int>    tail;
+
+    ring() : head(0), tail(0) {}
+};
+
+struct slab_backend {
+    static void * allocate(size_t size) { return slab_malloc(size); }
+    static void deallocate(void *ptr, size_t size) { slab_free(ptr, size); }
+};
+
+struct malloc_backend {
+    static void * allocate(size_t size) { (void)size; return malloc(size); }
+    static void deallocate(void *ptr, size_t size) { (void)size; free(ptr); }
+};
+
+template <class Backend>
+static void producer(ring *r, int count)
+{
+    for (int i=0; i < count; i++) {
+        void *p = Backend::allocate(16 + 16 * (i & 3));
+        int h = r->head.load(std::memory_order_relaxed);
+        while (h - r->tail.load(std::memory_order_acquire) == RING_SIZE)
+            std::this_thread::yield();
+        r->slots[h % RING_SIZE] = p;
+        r->head.store(h + 1, std::memory_order_release);
+    }
+}
+
+template <class Backend>
+static void consumer(ring *r, int count)
+{
+    for (int i=0; i < count; i++) {
+        int t = r->tail.load(std::memory_order_relaxed);
+        while (r->head.load(std::memory_order_acquire) == t)
+            std::this_thread::yield();
+        Backend::deallocate(r->slots[t % RING_SIZE], 16 + 16 * (i & 3));
+        r->tail.store(t + 1, std::memory_order_release);
+    }
+}
+
+template <class Backend>
+static double run(int pairs, int count)
+{
+    std::vector<ring> rings(pairs);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i=0; i < pairs; i++) {
+        threads.push_back(std::thread(producer<Backend>, &rings[i], count));
+        threads.push_back(std::thread(consumer<Backend>, &rings[i], count));
+    }
+    for (auto &th: threads)
+        th.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return (double)pairs * count / elapsed.count() / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    int count = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int max_pairs = (argc > 2) ? atoi(argv[2]) : (int)std::thread::hardware_concurrency() / 2;
+
+    if (max_pairs < 2)
+        max_pairs = 2;
+
+    printf("pairs    malloc Mops/s  slab Mops/s\n");
+    for (int p=1; p <= max_pairs; p *= 2) {
+        double libc = run<malloc_backend>(p, count);
+        double slab = run<slab_backend>(p, count);
+        printf("%5d  %15.2f  %11.2f\n", p, libc, slab);
+    }
+
+    return 0;
+}
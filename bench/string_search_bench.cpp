@@ -0,0 +1,67 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+
+#include <tinystl/string>
+
+// Scans a text for needles and delimiters which are not in it, so that every
+// call runs over the whole buffer. Run with TINYSTD_SIMD=scalar or sse2 to
+// compare the kernels.
+
+template <class Str, class Fn>
+static double run(const Str& text, int rounds, Fn fn)
+{
+    long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i=0; i < rounds; i++)
+        sink += fn(text);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (sink == 42)
+        printf(" ");
+    return (double)text.size() * rounds / elapsed.count() / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    int size = (argc > 1) ? atoi(argv[1]) : 1 << 20;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 200;
+
+    std::string ref;
+    for (int i=0; i < size; i++)
+        ref += "the quick brown fox jumps over a lazy dog "[i % 43];
+    tinystd::string text(ref.c_str(), size);
+
+    printf("search               std GB/s  tinystd GB/s\n");
+    printf("find(char)         %10.2f  %12.2f\n",
+        run(ref, rounds, [](const std::string& s) { return (long)s.find('Z'); }),
+        run(text, rounds, [](const tinystd::string& s) { return (long)s.find('Z'); }));
+    printf("find(string)       %10.2f  %12.2f\n",
+        run(ref, rounds, [](const std::string& s) { return (long)s.find("lazy cat"); }),
+        run(text, rounds, [](const tinystd::string& s) { return (long)s.find("lazy cat"); }));
+    printf("rfind(string)      %10.2f  %12.2f\n",
+        run(ref, rounds, [](const std::string& s) { return (long)s.rfind("quick fox"); }),
+        run(text, rounds, [](const tinystd::string& s) { return (long)s.rfind("quick fox"); }));
+    printf("find_first_of(4)   %10.2f  %12.2f\n",
+        run(ref, rounds, [](const std::string& s) { return (long)s.find_first_of(",;\t\n"); }),
+        run(text, rounds, [](const tinystd::string& s) { return (long)s.find_first_of(",;\t\n"); }));
+    printf("find_first_of(16)  %10.2f  %12.2f\n",
+        run(ref, rounds, [](const std::string& s) { return (long)s.find_first_of("0123456789,;:!?\n"); }),
+        run(text, rounds, [](const tinystd::string& s) { return (long)s.find_first_of("0123456789,;:!?\n"); }));
+    printf("find_last_not_of   %10.2f  %12.2f\n",
+        run(ref, rounds, [](const std::string& s) { return (long)s.find_last_not_of("abcdefghijklmnopqrstuvwxyz "); }),
+        run(text, rounds, [](const tinystd::string& s) { return (long)s.find_last_not_of("abcdefghijklmnopqrstuvwxyz "); }));
+
+    return 0;
+}
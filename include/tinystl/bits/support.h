@@ -15,10 +15,141 @@
 #include <type_traits>
 #include <iterator>
 
+// Allocation policies selectable at build time through TINYSTD_ALLOCATOR_POLICY:
+//   fast     - plain malloc/free, no walls, no zeroing
+//   guard    - walls around every block are checked on free, memory is not cleared
+//   mungwall - walls plus zeroing of every new block (default)
+//   runtime  - backend picked at startup from TINYSTD_ALLOC, see lib/backend.cpp
+#define TINYSTD_POLICY_FAST         0
+#define TINYSTD_POLICY_GUARD        1
+#define TINYSTD_POLICY_MUNGWALL     2
+#define TINYSTD_POLICY_RUNTIME      3
+
+#ifndef TINYSTD_ALLOCATOR_POLICY
+#define TINYSTD_ALLOCATOR_POLICY    TINYSTD_POLICY_MUNGWALL
+#endif
+
+// When set, allocations go through the thread-local cache in front of the policy above
+#ifndef TINYSTD_ALLOCATOR_CACHE
+#define TINYSTD_ALLOCATOR_CACHE     0
+#endif
+
+#if TINYSTD_ALLOCATOR_CACHE && TINYSTD_ALLOCATOR_POLICY == TINYSTD_POLICY_RUNTIME
+#error "The runtime policy selects the cache as TINYSTD_ALLOC=pool, build without TINYSTD_ALLOCATOR_CACHE"
+#endif
+
+// When set, the mungwall and guard policies keep the counters of tinystd::memory_stats()
+#ifndef TINYSTD_MEMORY_STATS
+#define TINYSTD_MEMORY_STATS        1
+#endif
+
+// When set, every mungwall/guard block is recorded in a registry of live allocations
+// together with its allocation site and type, see tinystd::dump_live_allocations()
+#ifndef TINYSTD_ALLOCATION_REGISTRY
+#define TINYSTD_ALLOCATION_REGISTRY 0
+#endif
+
+// When set, tinystd::allocator counts allocated bytes and hands a sample of
+// the allocations to the profiler in lib/sampling.cpp
+#ifndef TINYSTD_ALLOCATION_SAMPLING
+#define TINYSTD_ALLOCATION_SAMPLING 0
+#endif
+
+// Growth of string buffers when appending, in percent of the old capacity
+#ifndef TINYSTD_STRING_GROWTH
+#define TINYSTD_STRING_GROWTH       200
+#endif
+
+// Alignment guaranteed by plain allocations, stronger ones go through the *_memalign calls
+#define TINYSTD_MALLOC_ALIGN        16
+// Cache line size, arithmetic arrays of at least TINYSTD_CACHELINE_ARRAY bytes are aligned to it
+#define TINYSTD_CACHELINE           64
+// Smaller arrays keep the plain alignment, and with it the realloc path of the allocator
+#define TINYSTD_CACHELINE_ARRAY     4096
+
+// Blocks of at least this size are mapped directly with mmap, see lib/mmap.cpp
+#ifndef TINYSTD_MMAP_THRESHOLD
+#define TINYSTD_MMAP_THRESHOLD      (4 * 1024 * 1024)
+#endif
+
+// Huge page use of the mmap backend: none, madvise(MADV_HUGEPAGE) or MAP_HUGETLB
+#define TINYSTD_HUGEPAGES_NONE      0
+#define TINYSTD_HUGEPAGES_MADVISE   1
+#define TINYSTD_HUGEPAGES_HUGETLB   2
+
+#ifndef TINYSTD_HUGEPAGES
+#define TINYSTD_HUGEPAGES           TINYSTD_HUGEPAGES_MADVISE
+#endif
+
+// Blocks up to this size are served by the slab allocator, larger ones go to malloc
+#define SLAB_MAX_SIZE               256
+// Blocks up to this size are kept in the thread-local cache
+#define TCACHE_MAX_SIZE             256
+
 extern "C" {
 
 void * mungwall_malloc(size_t size);
 void mungwall_free(void *ptr, size_t size);
+void * guardwall_malloc(size_t size);
+void guardwall_free(void *ptr, size_t size);
+void * mungwall_malloc_tagged(size_t size, const char *tag, void *caller);
+void * guardwall_malloc_tagged(size_t size, const char *tag, void *caller);
+void * mungwall_memalign(size_t size, size_t align, const char *tag, void *caller);
+void mungwall_free_aligned(void *ptr, size_t size, size_t align);
+void * guardwall_memalign(size_t size, size_t align, const char *tag, void *caller);
+void guardwall_free_aligned(void *ptr, size_t size, size_t align);
+bool mungwall_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align);
+void * mungwall_realloc(void *ptr, size_t old_size, size_t new_size);
+bool guardwall_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align);
+void * guardwall_realloc(void *ptr, size_t old_size, size_t new_size);
+bool malloc_try_expand(void *ptr, size_t new_size);
+void * counted_malloc(size_t size, const char *tag, void *caller);
+void counted_free(void *ptr, size_t size);
+void * counted_memalign(size_t size, size_t align, const char *tag, void *caller);
+void counted_free_aligned(void *ptr, size_t size, size_t align);
+bool counted_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align);
+void * counted_realloc(void *ptr, size_t old_size, size_t new_size);
+void * slab_malloc(size_t size);
+void slab_free(void *ptr, size_t size);
+void * mmap_malloc(size_t size);
+void mmap_free(void *ptr, size_t size);
+void * mmap_realloc(void *ptr, size_t old_size, size_t new_size);
+bool mmap_try_expand(void *ptr, size_t old_size, size_t new_size);
+void * tcache_malloc(size_t size);
+void tcache_free(void *ptr, size_t size);
+bool tcache_try_expand(void *ptr, size_t old_size, size_t new_size);
+void * tcache_realloc(void *ptr, size_t old_size, size_t new_size);
+
+struct tcache_stats {
+    uint64_t    hits;       // allocations served straight from the thread's magazine
+    uint64_t    misses;     // allocations which found the magazine empty
+    uint64_t    refills;    // batches moved from the shared depot into a magazine
+    uint64_t    drains;     // batches moved from a magazine back to the depot
+};
+
+void tcache_get_stats(struct tcache_stats *stats);
+
+// Table of one allocation backend of the runtime policy
+struct alloc_backend {
+    const char *name;
+    void * (*malloc)(size_t size, const char *tag, void *caller);
+    void (*free)(void *ptr, size_t size);
+    void * (*memalign)(size_t size, size_t align, const char *tag, void *caller);
+    void (*free_aligned)(void *ptr, size_t size, size_t align);
+    bool (*try_expand)(void *ptr, size_t old_size, size_t new_size, size_t align);
+    void * (*realloc)(void *ptr, size_t old_size, size_t new_size);
+};
+
+// Active backend. Until the first call resolves TINYSTD_ALLOC it points to a
+// table which does so and then forwards.
+extern const struct alloc_backend *alloc_backend_active;
+const struct alloc_backend * alloc_backend_get(void);
+
+// Bytes left until the next allocation sample of this thread. The allocator
+// calls sample_allocation() once it drops below zero, which records the
+// allocation if sampling is on and sets up the next countdown.
+extern __thread int64_t allocation_sample_countdown;
+void sample_allocation(size_t size, const char *type);
 
 }
 
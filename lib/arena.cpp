@@ -0,0 +1,84 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdint.h>
+#include <tinystl/allocator>
+#include <tinystl/arena>
+
+namespace tinystd {
+
+arena::arena(size_t block_size)
+    : _blocks(nullptr), _begin(0), _current(0), _end(0), _used(0), _block_size(block_size)
+{
+}
+
+// Arena starting in a caller-provided buffer. The buffer is not owned and
+// is used again after every reset, as long as no larger block was chained.
+arena::arena(void *buffer, size_t size)
+    : _blocks(nullptr), _begin((uintptr_t)buffer), _current((uintptr_t)buffer),
+      _end((uintptr_t)buffer + size), _used(0), _block_size(size)
+{
+}
+
+arena::~arena()
+{
+    while (_blocks) {
+        block *b = _blocks;
+        _blocks = b->next;
+        base_policy::deallocate(b, b->size);
+    }
+}
+
+void * arena::grow(size_t size, size_t align)
+{
+    size_t block_size = _block_size;
+
+    // Every new block is at least twice as large as the previous one
+    if (_blocks && block_size < 2 * _blocks->size)
+        block_size = 2 * _blocks->size;
+    if (block_size < sizeof(block) + size + align)
+        block_size = sizeof(block) + size + align;
+
+    block *b = reinterpret_cast<block *>(base_policy::allocate(block_size));
+    if (b == nullptr)
+        return nullptr;
+
+    b->size = block_size;
+    b->next = _blocks;
+    _blocks = b;
+
+    _used += _current - _begin;
+    _begin = (uintptr_t)(b + 1);
+    _current = _begin;
+    _end = (uintptr_t)b + block_size;
+
+    return allocate(size, align);
+}
+
+void arena::reset()
+{
+    if (_blocks) {
+        // Keep the newest (and largest) block, release all older ones
+        block *keep = _blocks;
+        block *b = keep->next;
+        while (b) {
+            block *next = b->next;
+            base_policy::deallocate(b, b->size);
+            b = next;
+        }
+        keep->next = nullptr;
+        _blocks = keep;
+        _begin = (uintptr_t)(keep + 1);
+        _end = (uintptr_t)keep + keep->size;
+    }
+    _current = _begin;
+    _used = 0;
+}
+
+}
@@ -0,0 +1,176 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <tinystl/allocator>
+#include <tinystl/atom>
+
+// Interned strings. The table is an open addressing array of entry pointers
+// with linear probing, kept at most 3/4 full. Entries are never removed, so
+// no tombstones are needed, and their characters are bump allocated from an
+// arena next to the hash and length.
+
+namespace tinystd {
+
+namespace __internal__ {
+
+const atom_entry empty_atom = { 0, 0, { 0 } };
+
+// Eight bytes per step, with a multiply-xorshift finalizer
+size_t atom_hash(const char *s, int len)
+{
+    const uint64_t m = 0x9e3779b97f4a7c15ULL;
+    uint64_t h = (uint64_t)len * m;
+    uint64_t w;
+    for (; len >= 8; s += 8, len -= 8) {
+        memcpy(&w, s, 8);
+        h = (h ^ w) * m;
+        h ^= h >> 29;
+    }
+    if (len) {
+        w = 0;
+        memcpy(&w, s, len);
+        h = (h ^ w) * m;
+    }
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    // Zero is the hash of the empty atom only
+    return h ? h : 1;
+}
+
+}
+
+namespace {
+
+const size_t INITIAL_SLOTS = 256;
+
+}
+
+using __internal__::atom_entry;
+
+atom_table::atom_table() : _entries(16384), _slots(nullptr), _mask(0), _count(0)
+{
+}
+
+atom_table::~atom_table()
+{
+    if (_slots)
+        base_policy::deallocate(_slots, (_mask + 1) * sizeof(*_slots));
+}
+
+const atom_entry * atom_table::lookup(const char *s, int len, size_t hash) const
+{
+    if (_slots == nullptr)
+        return nullptr;
+    for (size_t i = hash & _mask; _slots[i]; i = (i + 1) & _mask) {
+        const atom_entry *e = _slots[i];
+        if (e->hash == hash && e->length == len && memcmp(e->chars, s, len) == 0)
+            return e;
+    }
+    return nullptr;
+}
+
+bool atom_table::grow()
+{
+    size_t count = _slots ? 2 * (_mask + 1) : INITIAL_SLOTS;
+    const atom_entry **slots = reinterpret_cast<const atom_entry **>(base_policy::allocate(count * sizeof(*slots)));
+    if (slots == nullptr)
+        return false;
+    memset(slots, 0, count * sizeof(*slots));
+
+    if (_slots) {
+        for (size_t i=0; i <= _mask; i++) {
+            if (_slots[i] == nullptr)
+                continue;
+            size_t j = _slots[i]->hash & (count - 1);
+            while (slots[j])
+                j = (j + 1) & (count - 1);
+            slots[j] = _slots[i];
+        }
+        base_policy::deallocate(_slots, (_mask + 1) * sizeof(*_slots));
+    }
+    _slots = slots;
+    _mask = count - 1;
+    return true;
+}
+
+atom atom_table::intern(string_view s)
+{
+    if (s.empty())
+        return atom();
+
+    size_t hash = __internal__::atom_hash(s.data(), s.size());
+    std::lock_guard<std::mutex> guard(_lock);
+
+    const atom_entry *e = lookup(s.data(), s.size(), hash);
+    if (e)
+        return atom(e);
+
+    if ((size_t)(_count + 1) * 4 > (_mask + 1) * 3 || _slots == nullptr) {
+        if (!grow())
+            return atom();
+    }
+
+    atom_entry *n = reinterpret_cast<atom_entry *>(_entries.allocate(offsetof(atom_entry, chars) + s.size() + 1, alignof(atom_entry)));
+    if (n == nullptr)
+        return atom();
+    n->hash = hash;
+    n->length = s.size();
+    memcpy(n->chars, s.data(), s.size());
+    n->chars[s.size()] = 0;
+
+    size_t i = hash & _mask;
+    while (_slots[i])
+        i = (i + 1) & _mask;
+    _slots[i] = n;
+    _count++;
+    return atom(n);
+}
+
+bool atom_table::find(string_view s, atom& a) const
+{
+    if (s.empty()) {
+        a = atom();
+        return true;
+    }
+
+    size_t hash = __internal__::atom_hash(s.data(), s.size());
+    std::lock_guard<std::mutex> guard(_lock);
+
+    const atom_entry *e = lookup(s.data(), s.size(), hash);
+    if (e)
+        a = atom(e);
+    return e != nullptr;
+}
+
+int atom_table::size() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _count;
+}
+
+size_t atom_table::memory_used() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _entries.used() + (_slots ? (_mask + 1) * sizeof(*_slots) : 0);
+}
+
+// Constructed on first use and never destroyed, atoms stay valid in static
+// destructors
+atom_table& atom_table::global()
+{
+    alignas(atom_table) static char storage[sizeof(atom_table)];
+    static atom_table *table = new(storage) atom_table();
+    return *table;
+}
+
+}
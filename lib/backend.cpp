@@ -0,0 +1,157 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tinystl/bits/support.h>
+
+// Backends of the runtime policy. TINYSTD_ALLOC names one of them:
+//   libc         - plain malloc/free (default)
+//   mungwall     - walled and cleared blocks, checked on free
+//   guard        - walled blocks, not cleared
+//   pool         - thread-local cache in front of malloc
+//   instrumented - malloc/free with the memory statistics kept
+// The choice is made once, on the first allocation, and never changes, so
+// that every block is released by the backend which allocated it.
+
+namespace {
+
+void * libc_malloc(size_t size, const char *tag, void *caller)
+{
+    (void)tag;
+    (void)caller;
+    return malloc(size);
+}
+
+void libc_free(void *ptr, size_t size)
+{
+    (void)size;
+    free(ptr);
+}
+
+void * libc_memalign(size_t size, size_t align, const char *tag, void *caller)
+{
+    (void)tag;
+    (void)caller;
+    void *p;
+    return posix_memalign(&p, align, size) ? nullptr : p;
+}
+
+void libc_free_aligned(void *ptr, size_t size, size_t align)
+{
+    (void)size;
+    (void)align;
+    free(ptr);
+}
+
+bool libc_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align)
+{
+    (void)old_size;
+    (void)align;
+    return malloc_try_expand(ptr, new_size);
+}
+
+void * libc_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+void * pool_malloc(size_t size, const char *tag, void *caller)
+{
+    (void)tag;
+    (void)caller;
+    return tcache_malloc(size);
+}
+
+// Aligned blocks bypass the cache
+bool pool_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align)
+{
+    if (align > TINYSTD_MALLOC_ALIGN)
+        return malloc_try_expand(ptr, new_size);
+    return tcache_try_expand(ptr, old_size, new_size);
+}
+
+const alloc_backend backends[] = {
+    { "libc", libc_malloc, libc_free, libc_memalign, libc_free_aligned, libc_try_expand, libc_realloc },
+    { "mungwall", mungwall_malloc_tagged, mungwall_free, mungwall_memalign, mungwall_free_aligned, mungwall_try_expand, mungwall_realloc },
+    { "guard", guardwall_malloc_tagged, guardwall_free, guardwall_memalign, guardwall_free_aligned, guardwall_try_expand, guardwall_realloc },
+    { "pool", pool_malloc, tcache_free, libc_memalign, libc_free_aligned, pool_try_expand, tcache_realloc },
+    { "instrumented", counted_malloc, counted_free, counted_memalign, counted_free_aligned, counted_try_expand, counted_realloc },
+};
+
+const alloc_backend * select_backend()
+{
+    const char *name = getenv("TINYSTD_ALLOC");
+
+    if (name && *name) {
+        for (size_t i=0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+            if (strcmp(name, backends[i].name) == 0)
+                return &backends[i];
+        }
+        fprintf(stderr, "tinystd: unknown TINYSTD_ALLOC backend '%s', using libc\n", name);
+    }
+
+    return &backends[0];
+}
+
+// Entries of the initial table, resolving the backend on first use. Nothing
+// can have been allocated before, so the free calls never see a block.
+void * resolve_malloc(size_t size, const char *tag, void *caller)
+{
+    return alloc_backend_get()->malloc(size, tag, caller);
+}
+
+void * resolve_memalign(size_t size, size_t align, const char *tag, void *caller)
+{
+    return alloc_backend_get()->memalign(size, align, tag, caller);
+}
+
+void resolve_free(void *ptr, size_t size)
+{
+    alloc_backend_get()->free(ptr, size);
+}
+
+void resolve_free_aligned(void *ptr, size_t size, size_t align)
+{
+    alloc_backend_get()->free_aligned(ptr, size, align);
+}
+
+bool resolve_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align)
+{
+    return alloc_backend_get()->try_expand(ptr, old_size, new_size, align);
+}
+
+void * resolve_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    return alloc_backend_get()->realloc(ptr, old_size, new_size);
+}
+
+const alloc_backend resolver = {
+    "unresolved", resolve_malloc, resolve_free, resolve_memalign, resolve_free_aligned, resolve_try_expand, resolve_realloc
+};
+
+}
+
+// Constant initialized, usable from static constructors of other units
+const struct alloc_backend *alloc_backend_active = &resolver;
+
+const struct alloc_backend * alloc_backend_get(void)
+{
+    const alloc_backend *b = __atomic_load_n(&alloc_backend_active, __ATOMIC_ACQUIRE);
+
+    // Racing threads resolve to the same table
+    if (b == &resolver) {
+        b = select_backend();
+        __atomic_store_n(&alloc_backend_active, b, __ATOMIC_RELEASE);
+    }
+
+    return b;
+}
@@ -11,7 +11,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <strings.h>
+#include <malloc.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cxxabi.h>
 #include <tinystl/bits/support.h>
+#include <tinystl/allocator>
 
 #ifdef USE_KPRINTF
 #define BUG(...) kprintf(__VA_ARGS__)
@@ -19,11 +25,241 @@
 #define BUG(...) printf(__VA_ARGS__)
 #endif
 
-void * mungwall_malloc(size_t size)
+namespace {
+
+// Statistics of the walled allocations. Every thread counts into its own
+// block and adds it to the shared counters in batches, so an allocation does
+// not touch any shared cache line most of the time. A snapshot therefore
+// lags behind by the batches other threads have not published yet.
+struct stats_counters {
+    std::atomic<uint64_t> allocs;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> total_bytes;
+    std::atomic<uint64_t> live_bytes;
+    std::atomic<uint64_t> peak_bytes;
+    std::atomic<uint64_t> size_classes[tinystd::MEMORY_SIZE_CLASSES];
+};
+
+stats_counters stats;
+const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+const int STATS_BATCH = 64;
+
+// Counts of this thread not yet added to stats. Trivially destructible, so
+// that frees from destructors running at thread exit can still be counted.
+struct local_counters {
+    uint64_t    allocs;
+    uint64_t    frees;
+    uint64_t    total_bytes;
+    int64_t     live_delta;
+    int64_t     peak_delta;         // highest live_delta since the last flush
+    uint64_t    size_classes[tinystd::MEMORY_SIZE_CLASSES];
+    int         pending;
+    bool        registered;         // exit_flush of the thread is armed
+    bool        exited;             // exit_flush has run, nothing is batched anymore
+};
+
+__thread local_counters local;
+
+void flush_stats()
+{
+    if (local.pending == 0)
+        return;
+
+    stats.allocs.fetch_add(local.allocs, std::memory_order_relaxed);
+    stats.frees.fetch_add(local.frees, std::memory_order_relaxed);
+    stats.total_bytes.fetch_add(local.total_bytes, std::memory_order_relaxed);
+    for (size_t i=0; i < tinystd::MEMORY_SIZE_CLASSES; i++) {
+        if (local.size_classes[i]) {
+            stats.size_classes[i].fetch_add(local.size_classes[i], std::memory_order_relaxed);
+            local.size_classes[i] = 0;
+        }
+    }
+
+    // The peak within the batch, on top of what the other threads had published
+    uint64_t live = stats.live_bytes.fetch_add((uint64_t)local.live_delta, std::memory_order_relaxed);
+    uint64_t high = live + (uint64_t)local.peak_delta;
+    uint64_t peak = stats.peak_bytes.load(std::memory_order_relaxed);
+    while (high > peak && !stats.peak_bytes.compare_exchange_weak(peak, high, std::memory_order_relaxed));
+
+    local.allocs = 0;
+    local.frees = 0;
+    local.total_bytes = 0;
+    local.live_delta = 0;
+    local.peak_delta = 0;
+    local.pending = 0;
+}
+
+// Publishes the counts of a thread when it exits
+struct exit_flush {
+    bool armed;
+    ~exit_flush() { flush_stats(); local.exited = true; }
+};
+
+thread_local exit_flush exit_flusher;
+
+inline void account_event()
+{
+    if (!local.registered) {
+        local.registered = true;
+        exit_flusher.armed = true;
+    }
+    if (++local.pending >= STATS_BATCH || local.exited)
+        flush_stats();
+}
+
+// Class n holds sizes in range (2^(n-1), 2^n]
+inline int size_class(size_t size)
+{
+    int cls = (size > 1) ? 64 - __builtin_clzl(size - 1) : 0;
+    return (cls < (int)tinystd::MEMORY_SIZE_CLASSES) ? cls : tinystd::MEMORY_SIZE_CLASSES - 1;
+}
+
+inline void account_live(int64_t delta)
+{
+    local.live_delta += delta;
+    if (local.live_delta > local.peak_delta)
+        local.peak_delta = local.live_delta;
+}
+
+inline void account_alloc(size_t size)
+{
+#if TINYSTD_MEMORY_STATS
+    local.allocs++;
+    local.total_bytes += size;
+    local.size_classes[size_class(size)]++;
+    account_live((int64_t)size);
+    account_event();
+#else
+    (void)size;
+#endif
+}
+
+inline void account_resize(size_t old_size, size_t new_size)
+{
+#if TINYSTD_MEMORY_STATS
+    local.total_bytes += new_size - old_size;
+    account_live((int64_t)new_size - (int64_t)old_size);
+    account_event();
+#else
+    (void)old_size;
+    (void)new_size;
+#endif
+}
+
+inline void account_free(size_t size)
+{
+#if TINYSTD_MEMORY_STATS
+    local.frees++;
+    account_live(-(int64_t)size);
+    account_event();
+#else
+    (void)size;
+#endif
+}
+
+// Registry of live blocks. Every walled block is preceded by a record linking
+// it into a global list together with the allocating site and type tag.
+struct live_record {
+    live_record    *prev;
+    live_record    *next;
+    void           *caller;
+    const char     *tag;
+};
+
+#if TINYSTD_ALLOCATION_REGISTRY
+const size_t RECORD_SIZE = (sizeof(live_record) + 15) & ~15;
+#else
+const size_t RECORD_SIZE = 0;
+#endif
+
+std::mutex registry_lock;
+live_record registry = { &registry, &registry, nullptr, nullptr };
+
+// Links the record preceding a given mungwall header, keeping its site and tag
+inline void link_block(void *header)
+{
+#if TINYSTD_ALLOCATION_REGISTRY
+    live_record *r = reinterpret_cast<live_record *>(reinterpret_cast<char *>(header) - RECORD_SIZE);
+
+    std::lock_guard<std::mutex> guard(registry_lock);
+    r->next = registry.next;
+    r->prev = &registry;
+    registry.next->prev = r;
+    registry.next = r;
+#else
+    (void)header;
+#endif
+}
+
+inline void register_block(void *header, const char *tag, void *caller)
+{
+#if TINYSTD_ALLOCATION_REGISTRY
+    live_record *r = reinterpret_cast<live_record *>(reinterpret_cast<char *>(header) - RECORD_SIZE);
+    r->caller = caller;
+    r->tag = tag;
+    link_block(header);
+#else
+    (void)header;
+    (void)tag;
+    (void)caller;
+#endif
+}
+
+// Unlinks the record preceding a given mungwall header
+inline void unregister_block(void *header)
+{
+#if TINYSTD_ALLOCATION_REGISTRY
+    live_record *r = reinterpret_cast<live_record *>(reinterpret_cast<char *>(header) - RECORD_SIZE);
+
+    std::lock_guard<std::mutex> guard(registry_lock);
+    r->prev->next = r->next;
+    r->next->prev = r->prev;
+#else
+    (void)header;
+#endif
+}
+
+void dump_at_exit()
+{
+    tinystd::dump_memory_stats(stderr);
+}
+
+// Setting TINYSTD_MEMSTATS in the environment prints the statistics at exit
+struct stats_env_check {
+    stats_env_check() { if (getenv("TINYSTD_MEMSTATS")) tinystd::memory_stats_at_exit(); }
+} env_check;
+
+}
+
+// Distance between start of the malloc'ed block and the returned pointer. The
+// 16-byte mungwall header (and registry record) sits right below the pointer,
+// for larger alignments the prefix is padded up to the alignment.
+static inline size_t wall_prefix(size_t align)
+{
+    size_t prefix = RECORD_SIZE + 16;
+    if (align > 16)
+        prefix = (prefix + align - 1) & ~(align - 1);
+    return prefix;
+}
+
+static inline void * wall_malloc(size_t size, size_t align, bool clear, const char *tag, void *caller)
 {
     size_t orig_size = size;
+    size_t prefix = wall_prefix(align);
     size = (size + 3) & ~3;
-    uint32_t *ptr = reinterpret_cast<uint32_t *>(malloc(size + 32));
+    void *block;
+    if (align > 16) {
+        if (posix_memalign(&block, align, prefix + size + 16))
+            return nullptr;
+    }
+    else {
+        block = malloc(prefix + size + 16);
+        if (block == nullptr)
+            return nullptr;
+    }
+    uint32_t *ptr = reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(block) + prefix) - 4;
+    register_block(ptr, tag, caller);
     ptr[0] = orig_size;
     ptr[1] = 0xdeadbeef;
     ptr[2] = 0xdeadbeef;
@@ -34,12 +270,15 @@ void * mungwall_malloc(size_t size)
     ptr[6 + size/4] = 0xcafebabe;
     ptr[7 + size/4] = 0xcafebabe;
 
-    bzero(&ptr[4], size);
+    if (clear)
+        bzero(&ptr[4], size);
+
+    account_alloc(orig_size);
 
     return &ptr[4];
 }
 
-void mungwall_free(void *ptr, size_t size)
+static inline void wall_free(void *ptr, size_t size, size_t align)
 {
     uint32_t *p = reinterpret_cast<uint32_t *>(ptr);
     size_t orig_size = size;
@@ -64,5 +303,313 @@ void mungwall_free(void *ptr, size_t size)
 #endif
     }
 
-    free(p);
+    account_free(orig_size);
+    unregister_block(p);
+
+    free(reinterpret_cast<char *>(ptr) - wall_prefix(align));
+}
+
+// Grows a block in place if the slack of the underlying malloc chunk can take
+// the new size together with the right wall. The wall is moved up and the
+// header updated, mungwall clears the bytes gained.
+static inline bool wall_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align, bool clear)
+{
+    uint32_t *p = reinterpret_cast<uint32_t *>(ptr) - 4;
+    size_t prefix = wall_prefix(align);
+    size_t old_rounded = (old_size + 3) & ~3;
+    size_t new_rounded = (new_size + 3) & ~3;
+
+    if (new_size < old_size || *p != (unsigned int)old_size)
+        return false;
+    if (prefix + new_rounded + 16 > malloc_usable_size(reinterpret_cast<char *>(ptr) - prefix))
+        return false;
+
+    if (clear)
+        bzero(&p[4 + old_rounded/4], new_rounded - old_rounded);
+
+    p[0] = new_size;
+    p[4 + new_rounded/4] = 0xcafebabe;
+    p[5 + new_rounded/4] = 0xcafebabe;
+    p[6 + new_rounded/4] = 0xcafebabe;
+    p[7 + new_rounded/4] = 0xcafebabe;
+
+    account_resize(old_size, new_size);
+
+    return true;
+}
+
+// Resizes a block with realloc(), which either extends the malloc chunk or
+// moves it. Only blocks with the default alignment qualify, realloc() would
+// not keep a stronger one.
+static inline void * wall_realloc(void *ptr, size_t old_size, size_t new_size, bool clear)
+{
+    uint32_t *p = reinterpret_cast<uint32_t *>(ptr) - 4;
+    size_t prefix = wall_prefix(0);
+    size_t old_rounded = (old_size + 3) & ~3;
+    size_t new_rounded = (new_size + 3) & ~3;
+
+    if (new_size < old_size || *p != (unsigned int)old_size)
+        return nullptr;
+
+    // The record moves together with the block, relink it afterwards
+    unregister_block(p);
+    void *block = realloc(reinterpret_cast<char *>(ptr) - prefix, prefix + new_rounded + 16);
+    if (block == nullptr) {
+        link_block(p);
+        return nullptr;
+    }
+
+    p = reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(block) + prefix) - 4;
+    link_block(p);
+
+    if (clear)
+        bzero(&p[4 + old_rounded/4], new_rounded - old_rounded);
+
+    p[0] = new_size;
+    p[4 + new_rounded/4] = 0xcafebabe;
+    p[5 + new_rounded/4] = 0xcafebabe;
+    p[6 + new_rounded/4] = 0xcafebabe;
+    p[7 + new_rounded/4] = 0xcafebabe;
+
+    account_resize(old_size, new_size);
+
+    return &p[4];
+}
+
+bool malloc_try_expand(void *ptr, size_t new_size)
+{
+    return ptr != nullptr && malloc_usable_size(ptr) >= new_size;
+}
+
+void * mungwall_malloc(size_t size)
+{
+    return wall_malloc(size, 0, true, nullptr, __builtin_return_address(0));
+}
+
+void * mungwall_malloc_tagged(size_t size, const char *tag, void *caller)
+{
+    return wall_malloc(size, 0, true, tag, caller);
+}
+
+void * mungwall_memalign(size_t size, size_t align, const char *tag, void *caller)
+{
+    return wall_malloc(size, align, true, tag, caller);
+}
+
+void mungwall_free(void *ptr, size_t size)
+{
+    wall_free(ptr, size, 0);
+}
+
+void mungwall_free_aligned(void *ptr, size_t size, size_t align)
+{
+    wall_free(ptr, size, align);
+}
+
+bool mungwall_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align)
+{
+    return wall_try_expand(ptr, old_size, new_size, align, true);
+}
+
+void * mungwall_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    return wall_realloc(ptr, old_size, new_size, true);
+}
+
+// Same layout and checks as mungwall, but the block is handed out uncleared
+void * guardwall_malloc(size_t size)
+{
+    return wall_malloc(size, 0, false, nullptr, __builtin_return_address(0));
+}
+
+void * guardwall_malloc_tagged(size_t size, const char *tag, void *caller)
+{
+    return wall_malloc(size, 0, false, tag, caller);
+}
+
+void * guardwall_memalign(size_t size, size_t align, const char *tag, void *caller)
+{
+    return wall_malloc(size, align, false, tag, caller);
+}
+
+void guardwall_free(void *ptr, size_t size)
+{
+    wall_free(ptr, size, 0);
+}
+
+void guardwall_free_aligned(void *ptr, size_t size, size_t align)
+{
+    wall_free(ptr, size, align);
+}
+
+bool guardwall_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align)
+{
+    return wall_try_expand(ptr, old_size, new_size, align, false);
+}
+
+void * guardwall_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    return wall_realloc(ptr, old_size, new_size, false);
+}
+
+// Instrumented malloc: statistics are kept, but there are no walls
+void * counted_malloc(size_t size, const char *tag, void *caller)
+{
+    (void)tag;
+    (void)caller;
+    void *p = malloc(size);
+    if (p)
+        account_alloc(size);
+    return p;
+}
+
+void counted_free(void *ptr, size_t size)
+{
+    account_free(size);
+    free(ptr);
+}
+
+void * counted_memalign(size_t size, size_t align, const char *tag, void *caller)
+{
+    (void)tag;
+    (void)caller;
+    void *p;
+    if (posix_memalign(&p, align, size))
+        return nullptr;
+    account_alloc(size);
+    return p;
+}
+
+void counted_free_aligned(void *ptr, size_t size, size_t align)
+{
+    (void)align;
+    account_free(size);
+    free(ptr);
+}
+
+bool counted_try_expand(void *ptr, size_t old_size, size_t new_size, size_t align)
+{
+    (void)align;
+    if (!malloc_try_expand(ptr, new_size))
+        return false;
+    account_resize(old_size, new_size);
+    return true;
+}
+
+void * counted_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    void *p = realloc(ptr, new_size);
+    if (p)
+        account_resize(old_size, new_size);
+    return p;
+}
+
+namespace tinystd {
+
+// Counts of other threads are published at every STATS_BATCH events and at exit
+memory_statistics memory_stats()
+{
+    memory_statistics st;
+
+#if TINYSTD_MEMORY_STATS
+    flush_stats();
+#endif
+    st.allocs = stats.allocs.load(std::memory_order_relaxed);
+    st.frees = stats.frees.load(std::memory_order_relaxed);
+    st.total_bytes = stats.total_bytes.load(std::memory_order_relaxed);
+    st.live_bytes = stats.live_bytes.load(std::memory_order_relaxed);
+    st.peak_bytes = stats.peak_bytes.load(std::memory_order_relaxed);
+    for (size_t i=0; i < MEMORY_SIZE_CLASSES; i++)
+        st.size_classes[i] = stats.size_classes[i].load(std::memory_order_relaxed);
+
+    std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - start_time;
+    st.uptime = uptime.count();
+    st.alloc_rate = st.uptime > 0 ? st.allocs / st.uptime : 0;
+    st.free_rate = st.uptime > 0 ? st.frees / st.uptime : 0;
+
+    return st;
+}
+
+void dump_memory_stats(FILE *out)
+{
+    memory_statistics st = memory_stats();
+
+    fprintf(out, "tinystd memory statistics after %.3f s:\n", st.uptime);
+    fprintf(out, "  allocations:  %llu (%.1f/s)\n", (unsigned long long)st.allocs, st.alloc_rate);
+    fprintf(out, "  frees:        %llu (%.1f/s)\n", (unsigned long long)st.frees, st.free_rate);
+    fprintf(out, "  total bytes:  %llu\n", (unsigned long long)st.total_bytes);
+    fprintf(out, "  live bytes:   %llu\n", (unsigned long long)st.live_bytes);
+    fprintf(out, "  peak bytes:   %llu\n", (unsigned long long)st.peak_bytes);
+    for (size_t i=0; i < MEMORY_SIZE_CLASSES; i++) {
+        if (st.size_classes[i])
+            fprintf(out, "  <= %-10llu %llu\n", 1ULL << i, (unsigned long long)st.size_classes[i]);
+    }
+}
+
+namespace {
+    struct live_site {
+        void       *caller;
+        const char *tag;
+        uint64_t    count;
+        uint64_t    bytes;
+    };
+}
+
+void dump_live_allocations(FILE *out)
+{
+#if TINYSTD_ALLOCATION_REGISTRY
+    std::lock_guard<std::mutex> guard(registry_lock);
+
+    size_t blocks = 0;
+    for (live_record *r = registry.next; r != &registry; r = r->next)
+        blocks++;
+
+    // Open-addressing table of sites, at most half full. Plain calloc,
+    // allocating through mungwall here would take the lock again
+    size_t table_size = 16;
+    while (table_size < 2 * blocks)
+        table_size *= 2;
+    live_site *sites = reinterpret_cast<live_site *>(calloc(table_size, sizeof(live_site)));
+    size_t site_count = 0;
+    if (sites == nullptr)
+        return;
+
+    for (live_record *r = registry.next; r != &registry; r = r->next) {
+        uint32_t size = *reinterpret_cast<uint32_t *>(reinterpret_cast<char *>(r) + RECORD_SIZE);
+        uint64_t h = ((uintptr_t)r->caller ^ (uintptr_t)r->tag * 0x9e3779b97f4a7c15ULL) * 0x100000001b3ULL;
+        size_t i = (h >> 17) & (table_size - 1);
+        while (sites[i].count && (sites[i].caller != r->caller || sites[i].tag != r->tag))
+            i = (i + 1) & (table_size - 1);
+        if (sites[i].count == 0) {
+            sites[i].caller = r->caller;
+            sites[i].tag = r->tag;
+            site_count++;
+        }
+        sites[i].count++;
+        sites[i].bytes += size;
+    }
+
+    fprintf(out, "tinystd live allocations: %llu blocks at %llu sites\n", (unsigned long long)blocks, (unsigned long long)site_count);
+    for (size_t i=0; i < table_size; i++) {
+        if (sites[i].count == 0)
+            continue;
+        char *name = sites[i].tag ? abi::__cxa_demangle(sites[i].tag, nullptr, nullptr, nullptr) : nullptr;
+        fprintf(out, "  %p %-40s %8llu blocks %12llu bytes\n", sites[i].caller, name ? name : (sites[i].tag ? sites[i].tag : "?"),
+            (unsigned long long)sites[i].count, (unsigned long long)sites[i].bytes);
+        free(name);
+    }
+
+    free(sites);
+#else
+    fprintf(out, "tinystd live allocations: registry not compiled in (TINYSTD_ALLOCATION_REGISTRY)\n");
+#endif
+}
+
+void memory_stats_at_exit()
+{
+    static std::atomic<bool> registered(false);
+    if (!registered.exchange(true))
+        atexit(dump_at_exit);
+}
+
 }
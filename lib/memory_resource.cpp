@@ -0,0 +1,56 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <atomic>
+#include <tinystl/allocator>
+#include <tinystl/memory_resource>
+
+namespace tinystd {
+
+namespace {
+
+class default_policy_resource : public memory_resource {
+protected:
+    void * do_allocate(size_t bytes, size_t alignment) override {
+        if (alignment > TINYSTD_MALLOC_ALIGN)
+            return default_policy::allocate_aligned(bytes, alignment, nullptr, __builtin_return_address(0));
+        return default_policy::allocate(bytes);
+    }
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        if (alignment > TINYSTD_MALLOC_ALIGN)
+            default_policy::deallocate_aligned(p, bytes, alignment);
+        else
+            default_policy::deallocate(p, bytes);
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+};
+
+default_policy_resource default_resource;
+std::atomic<memory_resource *> current_resource(&default_resource);
+
+}
+
+memory_resource * new_delete_resource() noexcept
+{
+    return &default_resource;
+}
+
+memory_resource * get_default_resource() noexcept
+{
+    return current_resource.load(std::memory_order_acquire);
+}
+
+memory_resource * set_default_resource(memory_resource *r) noexcept
+{
+    if (r == nullptr)
+        r = &default_resource;
+    return current_resource.exchange(r, std::memory_order_acq_rel);
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <tinystl/bits/support.h>
+
+// Backend for large buffers. Blocks are mapped directly from the kernel, so
+// that they can be backed by huge pages and grown with mremap() without
+// copying the contents.
+
+namespace {
+
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+inline size_t page_round(size_t size)
+{
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+inline size_t map_size(size_t size)
+{
+#if TINYSTD_HUGEPAGES == TINYSTD_HUGEPAGES_HUGETLB
+    return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+#else
+    return page_round(size);
+#endif
+}
+
+}
+
+void * mmap_malloc(size_t size)
+{
+    size_t len = map_size(size);
+    void *p = MAP_FAILED;
+
+#if TINYSTD_HUGEPAGES == TINYSTD_HUGEPAGES_HUGETLB
+    p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    // No (or not enough) reserved huge pages, fall back to regular mapping
+    if (p == MAP_FAILED)
+        p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+
+#if TINYSTD_HUGEPAGES == TINYSTD_HUGEPAGES_MADVISE && defined(MADV_HUGEPAGE)
+    if (len >= HUGE_PAGE_SIZE)
+        madvise(p, len, MADV_HUGEPAGE);
+#endif
+
+    return p;
+}
+
+void mmap_free(void *ptr, size_t size)
+{
+    if (ptr)
+        munmap(ptr, map_size(size));
+}
+
+// Resize a mapping, the kernel moves the pages instead of copying them
+void * mmap_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    size_t old_len = map_size(old_size);
+    size_t new_len = map_size(new_size);
+
+    if (old_len == new_len)
+        return ptr;
+
+    void *p = mremap(ptr, old_len, new_len, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED)
+        return nullptr;
+
+#if TINYSTD_HUGEPAGES == TINYSTD_HUGEPAGES_MADVISE && defined(MADV_HUGEPAGE)
+    if (new_len >= HUGE_PAGE_SIZE)
+        madvise(p, new_len, MADV_HUGEPAGE);
+#endif
+
+    return p;
+}
+
+// Grows a mapping without moving it, fails if the pages above are taken
+bool mmap_try_expand(void *ptr, size_t old_size, size_t new_size)
+{
+    size_t old_len = map_size(old_size);
+    size_t new_len = map_size(new_size);
+
+    if (new_len <= old_len)
+        return true;
+
+    return mremap(ptr, old_len, new_len, 0) != MAP_FAILED;
+}
@@ -0,0 +1,270 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <atomic>
+#include <mutex>
+#include <cxxabi.h>
+#include <tinystl/bits/support.h>
+#include <tinystl/allocator>
+
+// Sampling allocation profiler. allocator::allocate counts the requested
+// bytes down in a thread-local variable and calls sample_allocation() once
+// it drops below zero. The distance between samples is drawn from an
+// exponential distribution with the configured mean, so that every byte has
+// the same chance of being sampled regardless of allocation patterns. A
+// sampled allocation of size s stands for s / (1 - exp(-s/mean)) bytes.
+//
+// Samples are aggregated by backtrace and type in a fixed table, the profiler
+// never allocates itself. Frees are not tracked, the profile shows the
+// allocations made since sampling was started.
+
+__thread int64_t allocation_sample_countdown;
+
+namespace {
+
+const int MAX_FRAMES        = 32;
+const int SKIP_FRAMES       = 1;
+const size_t TABLE_SIZE     = 4096;
+// While sampling is off every thread looks again after this many bytes
+const int64_t RECHECK_BYTES = 64 * 1024 * 1024;
+
+struct sample_site {
+    uint64_t    hash;
+    const char *type;
+    int         depth;
+    void       *frames[MAX_FRAMES];
+    uint64_t    samples;            // number of sampled allocations
+    uint64_t    sampled_bytes;      // bytes of the sampled allocations
+    double      estimated_count;    // allocations they stand for
+    double      estimated_bytes;    // bytes they stand for
+};
+
+std::mutex sites_lock;
+sample_site sites[TABLE_SIZE];
+size_t site_count;
+uint64_t dropped;
+
+std::atomic<size_t> sample_interval(0);
+__thread uint64_t rng_state;
+
+// Exponentially distributed distance to the next sample
+int64_t next_interval(size_t mean)
+{
+    if (rng_state == 0)
+        rng_state = (uintptr_t)&rng_state ^ 0x9e3779b97f4a7c15ULL;
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+
+    double u = ((rng_state >> 11) + 0.5) / 9007199254740992.0;
+    return (int64_t)(-log(u) * mean) + 1;
+}
+
+uint64_t hash_site(void **frames, int depth, const char *type)
+{
+    uint64_t h = (uintptr_t)type;
+    for (int i=0; i < depth; i++)
+        h = (h ^ (uintptr_t)frames[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+void record(void **frames, int depth, const char *type, size_t size, size_t mean)
+{
+    uint64_t h = hash_site(frames, depth, type);
+    double p = 1.0 - exp(-(double)size / mean);
+
+    std::lock_guard<std::mutex> guard(sites_lock);
+
+    size_t i = h % TABLE_SIZE;
+    for (size_t probe=0; probe < TABLE_SIZE; probe++, i = (i + 1) % TABLE_SIZE) {
+        sample_site &s = sites[i];
+        if (s.samples == 0) {
+            if (site_count >= TABLE_SIZE * 3 / 4)
+                break;
+            s.hash = h;
+            s.type = type;
+            s.depth = depth;
+            memcpy(s.frames, frames, depth * sizeof(void *));
+            site_count++;
+        }
+        else if (s.hash != h || s.type != type || s.depth != depth || memcmp(s.frames, frames, depth * sizeof(void *)))
+            continue;
+
+        s.samples++;
+        s.sampled_bytes += size;
+        s.estimated_count += 1.0 / p;
+        s.estimated_bytes += size / p;
+        return;
+    }
+    dropped++;
+}
+
+// Name of a frame for the folded output, function name if the symbol is known
+void print_frame(FILE *out, void *addr)
+{
+    Dl_info info = {};
+    if (dladdr(addr, &info) == 0)
+        info = Dl_info();
+    if (info.dli_sname) {
+        char *name = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, nullptr);
+        fputs(name ? name : info.dli_sname, out);
+        free(name);
+    }
+    else if (info.dli_fname) {
+        const char *base = strrchr(info.dli_fname, '/');
+        fprintf(out, "%s+0x%lx", base ? base + 1 : info.dli_fname, (unsigned long)((char *)addr - (char *)info.dli_fbase));
+    }
+    else
+        fprintf(out, "%p", addr);
+}
+
+void dump_folded(FILE *out)
+{
+    for (size_t i=0; i < TABLE_SIZE; i++) {
+        const sample_site &s = sites[i];
+        if (s.samples == 0)
+            continue;
+
+        // Outermost frame first, the allocated type is the leaf
+        for (int f = s.depth - 1; f >= 0; f--) {
+            print_frame(out, s.frames[f]);
+            fputc(';', out);
+        }
+        char *name = abi::__cxa_demangle(s.type, nullptr, nullptr, nullptr);
+        fprintf(out, "[%s] %llu\n", name ? name : s.type, (unsigned long long)s.estimated_bytes);
+        free(name);
+    }
+}
+
+// Legacy pprof heap profile. pprof scales the raw samples by the rate given
+// in the header itself. In-use columns are zero since frees are not tracked,
+// use the alloc_space/alloc_objects sample index.
+void dump_pprof(FILE *out)
+{
+    uint64_t total_samples = 0;
+    uint64_t total_bytes = 0;
+    for (size_t i=0; i < TABLE_SIZE; i++) {
+        total_samples += sites[i].samples;
+        total_bytes += sites[i].sampled_bytes;
+    }
+
+    fprintf(out, "heap profile: %6d: %8d [%6llu: %8llu] @ heap_v2/%llu\n", 0, 0,
+        (unsigned long long)total_samples, (unsigned long long)total_bytes,
+        (unsigned long long)sample_interval.load(std::memory_order_relaxed));
+    for (size_t i=0; i < TABLE_SIZE; i++) {
+        const sample_site &s = sites[i];
+        if (s.samples == 0)
+            continue;
+        fprintf(out, "%6d: %8d [%6llu: %8llu] @", 0, 0, (unsigned long long)s.samples, (unsigned long long)s.sampled_bytes);
+        for (int f=0; f < s.depth; f++)
+            fprintf(out, " %p", s.frames[f]);
+        fputc('\n', out);
+    }
+
+    fputs("\nMAPPED_LIBRARIES:\n", out);
+    FILE *maps = fopen("/proc/self/maps", "r");
+    if (maps) {
+        char line[512];
+        while (fgets(line, sizeof(line), maps))
+            fputs(line, out);
+        fclose(maps);
+    }
+}
+
+const char *profile_path;
+
+void dump_at_exit()
+{
+    const char *suffix = strrchr(profile_path, '.');
+    FILE *f = fopen(profile_path, "w");
+    if (f == nullptr)
+        return;
+    tinystd::dump_allocation_samples(f, (suffix && strcmp(suffix, ".heap") == 0) ? tinystd::SAMPLES_PPROF : tinystd::SAMPLES_FOLDED);
+    fclose(f);
+}
+
+// TINYSTD_HEAP_SAMPLE=<bytes> starts sampling at startup, the profile is
+// written at exit to TINYSTD_HEAP_PROFILE (pprof format if it ends in .heap)
+struct sampling_env_check {
+    sampling_env_check()
+    {
+        const char *rate = getenv("TINYSTD_HEAP_SAMPLE");
+        if (rate == nullptr)
+            return;
+        tinystd::start_allocation_sampling(strtoul(rate, nullptr, 0));
+
+        profile_path = getenv("TINYSTD_HEAP_PROFILE");
+        if (profile_path == nullptr)
+            profile_path = "tinystd.folded";
+        atexit(dump_at_exit);
+    }
+} env_check;
+
+}
+
+void sample_allocation(size_t size, const char *type)
+{
+    size_t mean = sample_interval.load(std::memory_order_relaxed);
+    if (mean == 0) {
+        allocation_sample_countdown = RECHECK_BYTES;
+        return;
+    }
+
+    allocation_sample_countdown = next_interval(mean);
+
+    void *frames[MAX_FRAMES + SKIP_FRAMES];
+    int depth = backtrace(frames, MAX_FRAMES + SKIP_FRAMES) - SKIP_FRAMES;
+    if (depth < 0)
+        depth = 0;
+    record(frames + SKIP_FRAMES, depth, type, size, mean);
+}
+
+namespace tinystd {
+
+void start_allocation_sampling(size_t bytes_per_sample)
+{
+    if (bytes_per_sample == 0)
+        bytes_per_sample = 1;
+    // Load libgcc's unwinder now, backtrace() allocates on its first call
+    void *frame;
+    backtrace(&frame, 1);
+    sample_interval.store(bytes_per_sample, std::memory_order_relaxed);
+    allocation_sample_countdown = next_interval(bytes_per_sample);
+}
+
+void stop_allocation_sampling()
+{
+    sample_interval.store(0, std::memory_order_relaxed);
+}
+
+void dump_allocation_samples(FILE *out, sample_format format)
+{
+    std::lock_guard<std::mutex> guard(sites_lock);
+
+    if (format == SAMPLES_PPROF)
+        dump_pprof(out);
+    else
+        dump_folded(out);
+
+    if (dropped)
+        fprintf(stderr, "tinystd: %llu allocation samples dropped, sample table full\n", (unsigned long long)dropped);
+}
+
+}
@@ -0,0 +1,201 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <tinystl/bits/support.h>
+
+// Size-class slab allocator for small fixed-size objects (list nodes).
+// Every thread owns a heap with one pool per class. A pool keeps a free list
+// of returned blocks and carves new blocks from 64KB chunks, so that
+// consecutively allocated blocks share cache lines. The owning thread works
+// on its pools without any locking.
+//
+// Chunks are aligned to their size and start with a pointer to the owning
+// pool. A block freed by another thread is pushed onto the remote queue of
+// that pool, a lock-free stack which the owner takes over in one exchange
+// once its local free list runs empty. Since the owner always takes the
+// whole stack, the push side does not suffer from ABA.
+//
+// Heaps of exited threads are kept as orphans, still receiving remote frees,
+// and are adopted by new threads. A thread which has no heap (while it exits)
+// allocates from a shared heap under a lock. Chunks are never given back to
+// the system.
+
+namespace {
+
+const size_t SLAB_GRANULE   = 16;
+const size_t SLAB_CLASSES   = SLAB_MAX_SIZE / SLAB_GRANULE;
+const size_t SLAB_CHUNK     = 65536;
+const size_t CHUNK_HEADER   = 16;
+const size_t CACHE_LINE     = 64;
+
+struct free_block {
+    free_block *next;
+};
+
+struct pool;
+
+struct chunk_header {
+    pool       *owner;
+};
+
+// The remote queue is written by other threads, keep it off the owner's line
+struct pool {
+    free_block *free_list;
+    char       *bump;
+    char       *bump_end;
+    alignas(CACHE_LINE) std::atomic<free_block *> remote;
+};
+
+struct heap {
+    pool        pools[SLAB_CLASSES];
+    heap       *next_orphan;
+};
+
+std::mutex orphans_lock;
+heap *orphans;
+
+std::mutex shared_lock;
+heap *shared_heap;
+
+inline size_t slab_class(size_t size)
+{
+    return (size - 1) / SLAB_GRANULE;
+}
+
+inline chunk_header *chunk_of(void *ptr)
+{
+    return reinterpret_cast<chunk_header *>(reinterpret_cast<uintptr_t>(ptr) & ~(SLAB_CHUNK - 1));
+}
+
+heap *acquire_heap()
+{
+    {
+        std::lock_guard<std::mutex> guard(orphans_lock);
+        heap *h = orphans;
+        if (h) {
+            orphans = h->next_orphan;
+            return h;
+        }
+    }
+
+    void *mem = aligned_alloc(CACHE_LINE, sizeof(heap));
+    if (mem == nullptr)
+        return nullptr;
+    heap *h = new (mem) heap();
+    for (size_t i=0; i < SLAB_CLASSES; i++) {
+        h->pools[i].free_list = nullptr;
+        h->pools[i].bump = nullptr;
+        h->pools[i].bump_end = nullptr;
+        h->pools[i].remote.store(nullptr, std::memory_order_relaxed);
+    }
+    return h;
+}
+
+void release_heap(heap *h)
+{
+    std::lock_guard<std::mutex> guard(orphans_lock);
+    h->next_orphan = orphans;
+    orphans = h;
+}
+
+struct thread_heap {
+    heap *h;
+
+    thread_heap() : h(acquire_heap()) {}
+    ~thread_heap()
+    {
+        if (h)
+            release_heap(h);
+        h = nullptr;
+    }
+};
+
+thread_local thread_heap current;
+
+void * pool_malloc(pool &p, size_t block_size)
+{
+    free_block *b = p.free_list;
+    if (b == nullptr && p.remote.load(std::memory_order_relaxed) != nullptr)
+        b = p.remote.exchange(nullptr, std::memory_order_acquire);
+    if (b) {
+        p.free_list = b->next;
+        return b;
+    }
+
+    if (p.bump == nullptr || p.bump + block_size > p.bump_end) {
+        char *chunk = reinterpret_cast<char *>(aligned_alloc(SLAB_CHUNK, SLAB_CHUNK));
+        if (chunk == nullptr)
+            return nullptr;
+        reinterpret_cast<chunk_header *>(chunk)->owner = &p;
+        p.bump = chunk + CHUNK_HEADER;
+        p.bump_end = chunk + SLAB_CHUNK;
+    }
+
+    void *ptr = p.bump;
+    p.bump += block_size;
+    return ptr;
+}
+
+void remote_push(pool &p, free_block *b)
+{
+    free_block *head = p.remote.load(std::memory_order_relaxed);
+    do {
+        b->next = head;
+    } while (!p.remote.compare_exchange_weak(head, b, std::memory_order_release, std::memory_order_relaxed));
+}
+
+}
+
+void * slab_malloc(size_t size)
+{
+    if (size == 0 || size > SLAB_MAX_SIZE)
+        return malloc(size);
+
+    size_t cls = slab_class(size);
+    size_t block_size = (cls + 1) * SLAB_GRANULE;
+
+    heap *h = current.h;
+    if (h == nullptr) {
+        std::lock_guard<std::mutex> guard(shared_lock);
+        if (shared_heap == nullptr)
+            shared_heap = acquire_heap();
+        if (shared_heap == nullptr)
+            return nullptr;
+        return pool_malloc(shared_heap->pools[cls], block_size);
+    }
+
+    return pool_malloc(h->pools[cls], block_size);
+}
+
+void slab_free(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return;
+
+    if (size == 0 || size > SLAB_MAX_SIZE) {
+        free(ptr);
+        return;
+    }
+
+    heap *h = current.h;
+    pool *owner = chunk_of(ptr)->owner;
+    free_block *b = reinterpret_cast<free_block *>(ptr);
+
+    if (h && owner == &h->pools[slab_class(size)]) {
+        b->next = owner->free_list;
+        owner->free_list = b;
+    }
+    else
+        remote_push(*owner, b);
+}
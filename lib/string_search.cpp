@@ -0,0 +1,432 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <tinystl/string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEARCH_X86 1
+#else
+#define SEARCH_X86 0
+#endif
+
+// Search kernels of basic_string<char>. The level is picked once from the
+// CPU features and may be capped with TINYSTD_SIMD=scalar|sse2|avx2.
+//
+// Substring search compares the first and the last character of the needle
+// against a whole block of candidate positions at once and verifies only the
+// positions where both match. Character sets are kept as 256-bit bitmaps.
+// With AVX2 the bitmap is split by the nibbles of each byte and looked up
+// with vpshufb; SSE2 has no byte shuffle and handles small sets with one
+// compare per set member. Only full blocks are searched with vectors, the
+// remainder is done by the scalar code. Single characters are left to
+// memchr and memrchr of libc, which are vectorized already.
+
+namespace {
+
+enum {
+    LEVEL_SCALAR,
+    LEVEL_SSE2,
+    LEVEL_AVX2,
+};
+
+const int NPOS = -1;
+
+int detect_level()
+{
+    int level = LEVEL_SCALAR;
+
+#if SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        level = LEVEL_SSE2;
+    if (__builtin_cpu_supports("avx2"))
+        level = LEVEL_AVX2;
+#endif
+
+    const char *cap = getenv("TINYSTD_SIMD");
+    if (cap && *cap) {
+        if (strcmp(cap, "scalar") == 0)
+            level = LEVEL_SCALAR;
+        else if (strcmp(cap, "sse2") == 0)
+            level = level < LEVEL_SSE2 ? level : LEVEL_SSE2;
+        else if (strcmp(cap, "avx2") != 0)
+            fprintf(stderr, "tinystd: unknown TINYSTD_SIMD level '%s', ignored\n", cap);
+    }
+
+    return level;
+}
+
+std::atomic<int> search_level(-1);
+
+// Racing threads detect the same level
+inline int simd_level()
+{
+    int level = search_level.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = detect_level();
+        search_level.store(level, std::memory_order_relaxed);
+    }
+    return level;
+}
+
+struct char_set {
+    uint8_t bits[32];
+
+    char_set(const char *set, int n)
+    {
+        memset(bits, 0, sizeof(bits));
+        for (int i=0; i < n; i++)
+            bits[(uint8_t)set[i] >> 3] |= 1 << (set[i] & 7);
+    }
+
+    bool contains(char c) const { return bits[(uint8_t)c >> 3] & (1 << (c & 7)); }
+};
+
+// Scalar versions, also used for the tails of the vector kernels
+
+int find_scalar(const char *s, int from, int last, const char *needle, int n)
+{
+    for (int i=from; i <= last; i++) {
+        if (s[i] == needle[0] && memcmp(s + i, needle, n) == 0)
+            return i;
+    }
+    return NPOS;
+}
+
+int rfind_scalar(const char *s, int from, const char *needle, int n)
+{
+    for (int i=from; i >= 0; i--) {
+        if (s[i] == needle[0] && memcmp(s + i, needle, n) == 0)
+            return i;
+    }
+    return NPOS;
+}
+
+int find_of_scalar(const char *s, int from, int len, const char_set& set, bool match)
+{
+    for (int i=from; i < len; i++) {
+        if (set.contains(s[i]) == match)
+            return i;
+    }
+    return NPOS;
+}
+
+int rfind_of_scalar(const char *s, int from, const char_set& set, bool match)
+{
+    for (int i=from; i >= 0; i--) {
+        if (set.contains(s[i]) == match)
+            return i;
+    }
+    return NPOS;
+}
+
+#if SEARCH_X86
+
+// SSE2 kernels
+
+__attribute__((target("sse2")))
+int find_sse2(const char *s, int len, const char *needle, int n, int pos)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    int i = pos;
+
+    for (; i + n - 1 + 16 <= len; i += 16) {
+        __m128i f = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(s + i)));
+        __m128i l = _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *)(s + i + n - 1)));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(f, l));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(s + i + bit, needle, n) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar(s, i, len - n, needle, n);
+}
+
+__attribute__((target("sse2")))
+int rfind_sse2(const char *s, const char *needle, int n, int start)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    int i = start - 15;
+
+    for (; i >= 0; i -= 16) {
+        __m128i f = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(s + i)));
+        __m128i l = _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i *)(s + i + n - 1)));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(f, l));
+        while (mask) {
+            int bit = 31 - __builtin_clz(mask);
+            if (memcmp(s + i + bit, needle, n) == 0)
+                return i + bit;
+            mask &= ~(1u << bit);
+        }
+    }
+
+    return rfind_scalar(s, i + 15, needle, n);
+}
+
+// Sets of up to SSE2_SET_MAX members, one compare each
+const int SSE2_SET_MAX = 8;
+
+__attribute__((target("sse2")))
+inline unsigned set_mask_sse2(__m128i x, const __m128i *members, int n, bool match)
+{
+    __m128i hit = _mm_setzero_si128();
+    for (int k=0; k < n; k++)
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(x, members[k]));
+    unsigned mask = _mm_movemask_epi8(hit);
+    return match ? mask : mask ^ 0xffff;
+}
+
+__attribute__((target("sse2")))
+int find_of_sse2(const char *s, int len, const char *set, int n, int pos, bool match)
+{
+    __m128i members[SSE2_SET_MAX];
+    for (int k=0; k < n; k++)
+        members[k] = _mm_set1_epi8(set[k]);
+    int i = pos;
+
+    for (; i + 16 <= len; i += 16) {
+        unsigned mask = set_mask_sse2(_mm_loadu_si128((const __m128i *)(s + i)), members, n, match);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return find_of_scalar(s, i, len, char_set(set, n), match);
+}
+
+__attribute__((target("sse2")))
+int rfind_of_sse2(const char *s, const char *set, int n, int start, bool match)
+{
+    __m128i members[SSE2_SET_MAX];
+    for (int k=0; k < n; k++)
+        members[k] = _mm_set1_epi8(set[k]);
+    int i = start - 15;
+
+    for (; i >= 0; i -= 16) {
+        unsigned mask = set_mask_sse2(_mm_loadu_si128((const __m128i *)(s + i)), members, n, match);
+        if (mask)
+            return i + 31 - __builtin_clz(mask);
+    }
+
+    return rfind_of_scalar(s, i + 15, char_set(set, n), match);
+}
+
+// AVX2 kernels
+
+__attribute__((target("avx2")))
+int find_avx2(const char *s, int len, const char *needle, int n, int pos)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    int i = pos;
+
+    for (; i + n - 1 + 32 <= len; i += 32) {
+        __m256i f = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(s + i)));
+        __m256i l = _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(s + i + n - 1)));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(f, l));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(s + i + bit, needle, n) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    return find_scalar(s, i, len - n, needle, n);
+}
+
+__attribute__((target("avx2")))
+int rfind_avx2(const char *s, const char *needle, int n, int start)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    int i = start - 31;
+
+    for (; i >= 0; i -= 32) {
+        __m256i f = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(s + i)));
+        __m256i l = _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(s + i + n - 1)));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(f, l));
+        while (mask) {
+            int bit = 31 - __builtin_clz(mask);
+            if (memcmp(s + i + bit, needle, n) == 0)
+                return i + bit;
+            mask &= ~(1u << bit);
+        }
+    }
+
+    return rfind_scalar(s, i + 31, needle, n);
+}
+
+// Bitmap rows indexed by the low nibble, one bit per high nibble. Rows of
+// high nibbles 0-7 and 8-15 are kept in separate tables.
+struct nibble_tables {
+    __m256i low;
+    __m256i high;
+    __m256i bit;
+
+    __attribute__((target("avx2")))
+    nibble_tables(const char *set, int n)
+    {
+        alignas(16) uint8_t lo[16] = { 0 };
+        alignas(16) uint8_t hi[16] = { 0 };
+        for (int k=0; k < n; k++) {
+            uint8_t c = set[k];
+            if (c < 0x80)
+                lo[c & 15] |= 1 << (c >> 4);
+            else
+                hi[c & 15] |= 1 << ((c >> 4) - 8);
+        }
+        low = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)lo));
+        high = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)hi));
+        bit = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                               1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    }
+};
+
+__attribute__((target("avx2")))
+inline unsigned set_mask_avx2(__m256i x, const nibble_tables& t, bool match)
+{
+    const __m256i nibble = _mm256_set1_epi8(15);
+    __m256i lo = _mm256_and_si256(x, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+
+    __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(t.low, lo), _mm256_shuffle_epi8(t.high, lo),
+                                     _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7)));
+    __m256i bit = _mm256_shuffle_epi8(t.bit, hi);
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit));
+    return match ? mask : ~mask;
+}
+
+__attribute__((target("avx2")))
+int find_of_avx2(const char *s, int len, const char *set, int n, int pos, bool match)
+{
+    nibble_tables t(set, n);
+    int i = pos;
+
+    for (; i + 32 <= len; i += 32) {
+        unsigned mask = set_mask_avx2(_mm256_loadu_si256((const __m256i *)(s + i)), t, match);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return find_of_scalar(s, i, len, char_set(set, n), match);
+}
+
+__attribute__((target("avx2")))
+int rfind_of_avx2(const char *s, const char *set, int n, int start, bool match)
+{
+    nibble_tables t(set, n);
+    int i = start - 31;
+
+    for (; i >= 0; i -= 32) {
+        unsigned mask = set_mask_avx2(_mm256_loadu_si256((const __m256i *)(s + i)), t, match);
+        if (mask)
+            return i + 31 - __builtin_clz(mask);
+    }
+
+    return rfind_of_scalar(s, i + 31, char_set(set, n), match);
+}
+
+#endif
+
+}
+
+namespace tinystd {
+namespace __internal__ {
+
+int str_find(const char *s, int len, const char *needle, int n, int pos)
+{
+    if (pos < 0 || pos > len || n > len - pos)
+        return NPOS;
+    if (n == 0)
+        return pos;
+    if (n == 1) {
+        const char *p = (const char *)memchr(s + pos, needle[0], len - pos);
+        return p ? p - s : NPOS;
+    }
+
+#if SEARCH_X86
+    switch (simd_level()) {
+        case LEVEL_AVX2: return find_avx2(s, len, needle, n, pos);
+        case LEVEL_SSE2: return find_sse2(s, len, needle, n, pos);
+    }
+#endif
+    return find_scalar(s, pos, len - n, needle, n);
+}
+
+int str_rfind(const char *s, int len, const char *needle, int n, int pos)
+{
+    if (n > len)
+        return NPOS;
+    int start = len - n;
+    if (pos >= 0 && pos < start)
+        start = pos;
+    if (n == 0)
+        return start;
+    if (n == 1) {
+        const char *p = (const char *)memrchr(s, needle[0], start + 1);
+        return p ? p - s : NPOS;
+    }
+
+#if SEARCH_X86
+    switch (simd_level()) {
+        case LEVEL_AVX2: return rfind_avx2(s, needle, n, start);
+        case LEVEL_SSE2: return rfind_sse2(s, needle, n, start);
+    }
+#endif
+    return rfind_scalar(s, start, needle, n);
+}
+
+int str_find_of(const char *s, int len, const char *set, int n, int pos, bool match)
+{
+    if (pos < 0 || pos >= len)
+        return NPOS;
+    if (n == 1 && match)
+        return str_find(s, len, set, 1, pos);
+
+#if SEARCH_X86
+    int level = simd_level();
+    if (level == LEVEL_AVX2)
+        return find_of_avx2(s, len, set, n, pos, match);
+    if (level == LEVEL_SSE2 && n <= SSE2_SET_MAX)
+        return find_of_sse2(s, len, set, n, pos, match);
+#endif
+    return find_of_scalar(s, pos, len, char_set(set, n), match);
+}
+
+int str_rfind_of(const char *s, int len, const char *set, int n, int pos, bool match)
+{
+    int start = len - 1;
+    if (pos >= 0 && pos < start)
+        start = pos;
+    if (n == 1 && match)
+        return str_rfind(s, len, set, 1, start);
+
+#if SEARCH_X86
+    int level = simd_level();
+    if (level == LEVEL_AVX2)
+        return rfind_of_avx2(s, set, n, start, match);
+    if (level == LEVEL_SSE2 && n <= SSE2_SET_MAX)
+        return rfind_of_sse2(s, set, n, start, match);
+#endif
+    return rfind_of_scalar(s, start, char_set(set, n), match);
+}
+
+}
+}
@@ -0,0 +1,230 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <tinystl/allocator>
+#include <tinystl/bits/support.h>
+
+// Thread-local caching front-end. Every thread keeps a magazine (a stack of
+// free blocks) per size class. Allocations and frees are served from the
+// magazine without any locking; only when it runs empty or full, half of it is
+// refilled from or drained to the shared depot in one batch. The depot gets
+// fresh blocks from and returns surplus ones to the base allocation policy.
+
+namespace {
+
+const size_t TCACHE_GRANULE     = 16;
+const size_t TCACHE_CLASSES     = TCACHE_MAX_SIZE / TCACHE_GRANULE;
+const int    MAGAZINE_SIZE      = 64;
+const int    BATCH_SIZE         = MAGAZINE_SIZE / 2;
+const size_t DEPOT_LIMIT        = 16 * MAGAZINE_SIZE;
+
+// The runtime policy selects the cache as one of its backends, the cache then
+// gets its blocks from malloc
+#if TINYSTD_ALLOCATOR_POLICY == TINYSTD_POLICY_RUNTIME
+typedef tinystd::fast_policy backend;
+#else
+typedef tinystd::base_policy backend;
+#endif
+
+struct free_block {
+    free_block *next;
+};
+
+struct depot {
+    std::mutex  lock;
+    free_block *blocks;
+    size_t      count;
+};
+
+depot depots[TCACHE_CLASSES];
+
+std::atomic<uint64_t> total_hits;
+std::atomic<uint64_t> total_misses;
+std::atomic<uint64_t> total_refills;
+std::atomic<uint64_t> total_drains;
+
+inline size_t tcache_class(size_t size) { return (size - 1) / TCACHE_GRANULE; }
+inline size_t class_size(size_t cls) { return (cls + 1) * TCACHE_GRANULE; }
+
+// Set once the cache of this thread is destroyed. Destructors of statics and
+// of other thread_locals may still allocate and free afterwards, these calls
+// go to the backend directly.
+__thread bool cache_gone;
+
+struct thread_cache {
+    struct magazine {
+        void   *slots[MAGAZINE_SIZE];
+        int     count;
+    } mags[TCACHE_CLASSES];
+
+    uint64_t hits;
+    uint64_t misses;
+
+    thread_cache() : hits(0), misses(0) { for (size_t i=0; i < TCACHE_CLASSES; i++) mags[i].count = 0; }
+    ~thread_cache()
+    {
+        cache_gone = true;
+        for (size_t i=0; i < TCACHE_CLASSES; i++) {
+            if (mags[i].count)
+                drain(i, mags[i].count);
+        }
+        flush_stats();
+    }
+
+    void flush_stats()
+    {
+        total_hits.fetch_add(hits, std::memory_order_relaxed);
+        total_misses.fetch_add(misses, std::memory_order_relaxed);
+        hits = 0;
+        misses = 0;
+    }
+
+    // Take up to BATCH_SIZE blocks from the depot, top up from the backend
+    void refill(size_t cls)
+    {
+        magazine &m = mags[cls];
+        depot &d = depots[cls];
+        {
+            std::lock_guard<std::mutex> guard(d.lock);
+            while (d.blocks && m.count < BATCH_SIZE) {
+                free_block *b = d.blocks;
+                d.blocks = b->next;
+                d.count--;
+                m.slots[m.count++] = b;
+            }
+        }
+        while (m.count < BATCH_SIZE) {
+            void *p = backend::allocate(class_size(cls));
+            if (p == nullptr)
+                break;
+            m.slots[m.count++] = p;
+        }
+        total_refills.fetch_add(1, std::memory_order_relaxed);
+        flush_stats();
+    }
+
+    // Move the topmost n blocks of the magazine to the depot
+    void drain(size_t cls, int n)
+    {
+        magazine &m = mags[cls];
+        depot &d = depots[cls];
+        free_block *surplus = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(d.lock);
+            while (n--) {
+                free_block *b = reinterpret_cast<free_block *>(m.slots[--m.count]);
+                if (d.count < DEPOT_LIMIT) {
+                    b->next = d.blocks;
+                    d.blocks = b;
+                    d.count++;
+                } else {
+                    b->next = surplus;
+                    surplus = b;
+                }
+            }
+        }
+        while (surplus) {
+            free_block *b = surplus;
+            surplus = b->next;
+            backend::deallocate(b, class_size(cls));
+        }
+        total_drains.fetch_add(1, std::memory_order_relaxed);
+        flush_stats();
+    }
+};
+
+thread_local thread_cache cache;
+
+}
+
+void * tcache_malloc(size_t size)
+{
+    if (size == 0 || size > TCACHE_MAX_SIZE)
+        return backend::allocate(size);
+
+    size_t cls = tcache_class(size);
+    if (cache_gone)
+        return backend::allocate(class_size(cls));
+
+    thread_cache &tc = cache;
+    thread_cache::magazine &m = tc.mags[cls];
+
+    if (m.count) {
+        tc.hits++;
+        return m.slots[--m.count];
+    }
+
+    tc.misses++;
+    tc.refill(cls);
+    if (m.count)
+        return m.slots[--m.count];
+
+    return nullptr;
+}
+
+void tcache_free(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return;
+
+    if (size == 0 || size > TCACHE_MAX_SIZE) {
+        backend::deallocate(ptr, size);
+        return;
+    }
+
+    size_t cls = tcache_class(size);
+    if (cache_gone) {
+        backend::deallocate(ptr, class_size(cls));
+        return;
+    }
+
+    thread_cache &tc = cache;
+    thread_cache::magazine &m = tc.mags[cls];
+
+    if (m.count == MAGAZINE_SIZE)
+        tc.drain(cls, BATCH_SIZE);
+
+    m.slots[m.count++] = ptr;
+}
+
+// Cached blocks are handed out with the full size of their class, a block can
+// grow in place as long as it stays within the class. Larger blocks belong to
+// the backend.
+bool tcache_try_expand(void *ptr, size_t old_size, size_t new_size)
+{
+    if (old_size > TCACHE_MAX_SIZE)
+        return backend::try_expand(ptr, old_size, new_size, 0);
+    if (old_size == 0 || new_size > TCACHE_MAX_SIZE)
+        return false;
+
+    return tcache_class(old_size) == tcache_class(new_size);
+}
+
+void * tcache_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+    if (old_size > TCACHE_MAX_SIZE)
+        return backend::reallocate(ptr, old_size, new_size);
+
+    return nullptr;
+}
+
+// Counters of other threads are published at their next refill, drain or exit
+void tcache_get_stats(struct tcache_stats *stats)
+{
+    if (!cache_gone)
+        cache.flush_stats();
+    stats->hits = total_hits.load(std::memory_order_relaxed);
+    stats->misses = total_misses.load(std::memory_order_relaxed);
+    stats->refills = total_refills.load(std::memory_order_relaxed);
+    stats->drains = total_drains.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,107 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <tinystl/arena>
+#include <tinystl/vector>
+#include <tinystl/list>
+#include <tinystl/string>
+
+TEST_CASE("tinystl::arena class", "[tinystl::arena]") {
+
+    SECTION("Allocation") {
+        tinystd::arena a(256);
+
+        char *p1 = (char *)a.allocate(10, 1);
+        char *p2 = (char *)a.allocate(10, 1);
+        CHECK( p2 == p1 + 10 );
+
+        void *p3 = a.allocate(8, 8);
+        CHECK( ((uintptr_t)p3 & 7) == 0 );
+
+        // Larger than the block size, a new block has to be chained
+        void *p4 = a.allocate(1000);
+        CHECK( p4 != nullptr );
+        CHECK( a.used() >= 1028 );
+
+        a.reset();
+        CHECK( a.used() == 0 );
+    }
+
+    SECTION("External buffer") {
+        char buffer[128];
+        tinystd::arena a(buffer, sizeof(buffer));
+
+        char *p = (char *)a.allocate(16);
+        CHECK( (p >= buffer && p < buffer + sizeof(buffer)) );
+
+        a.reset();
+        CHECK( (char *)a.allocate(16) == p );
+    }
+
+    SECTION("vector in arena") {
+        tinystd::arena a;
+        tinystd::arena_allocator<int> alloc(a);
+        tinystd::vector<int, tinystd::arena_allocator<int> > v(alloc);
+
+        for (int i=0; i < 100; i++) v.push_back(i);
+
+        CHECK( v.size() == 100 );
+        for (int i=0; i < 100; i++) {
+            CHECK( v[i] == i );
+        }
+        CHECK( v.get_allocator() == alloc );
+    }
+
+    SECTION("list in arena") {
+        tinystd::arena a;
+        tinystd::arena_allocator<tinystd::string> alloc(a);
+        tinystd::list<tinystd::string, tinystd::arena_allocator<tinystd::string> > l(alloc);
+
+        l.push_back("one");
+        l.push_back("two");
+        l.push_front("zero");
+
+        const char *expected[] = { "zero", "one", "two" };
+        int i = 0;
+        for (auto it = l.begin(); it != l.end(); ++it, ++i) {
+            CHECK( *it == expected[i] );
+        }
+
+        size_t used = a.used();
+        CHECK( used >= 3 * sizeof(tinystd::string) );
+
+        tinystd::list<tinystd::string, tinystd::arena_allocator<tinystd::string> > copy(l);
+        CHECK( copy.size() == 3 );
+        CHECK( a.used() > used );
+    }
+
+    SECTION("string in arena") {
+        typedef tinystd::basic_string<char, tinystd::arena_allocator<char> > arena_string;
+        tinystd::arena a;
+        tinystd::arena_allocator<char> alloc(a);
+
+        // Short strings stay in the object
+        arena_string s("temporary", alloc);
+        CHECK( a.used() == 0 );
+
+        s.append(100, 'x');
+        size_t used = a.used();
+        CHECK( used > 0 );
+        s.append(100, 'y');
+        CHECK( s.length() == 209 );
+        CHECK( a.used() > used );
+
+        arena_string t = s + "!";
+        CHECK( t.length() == 210 );
+        CHECK( t.get_allocator() == alloc );
+    }
+}
@@ -0,0 +1,91 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <tinystl/atom>
+
+TEST_CASE("tinystl::atom class", "[tinystl::atom]") {
+
+    SECTION("Interning") {
+        tinystd::atom_table table;
+        tinystd::string key("request.latency");
+
+        tinystd::atom a = table.intern("request.latency");
+        tinystd::atom b = table.intern(key);
+        tinystd::atom c = table.intern("request.count");
+        CHECK( a == b );
+        CHECK( a != c );
+        CHECK( a.c_str() == b.c_str() );
+        CHECK( a.hash() == b.hash() );
+        CHECK( strcmp(a.c_str(), "request.latency") == 0 );
+        CHECK( a.size() == 15 );
+        CHECK( a.view() == "request.latency" );
+        CHECK( a.str() == key );
+        CHECK( table.size() == 2 );
+
+        tinystd::atom empty;
+        CHECK( empty.empty() );
+        CHECK( table.intern("") == empty );
+        CHECK( empty.c_str()[0] == 0 );
+    }
+
+    SECTION("Find") {
+        tinystd::atom_table table;
+        tinystd::atom a;
+        CHECK( !table.find("missing", a) );
+        tinystd::atom b = table.intern("present");
+        CHECK( table.find("present", a) );
+        CHECK( a == b );
+        CHECK( table.size() == 1 );
+    }
+
+    SECTION("Growth") {
+        tinystd::atom_table table;
+        tinystd::atom atoms[5000];
+        char name[32];
+        for (int i=0; i < 5000; i++) {
+            snprintf(name, sizeof(name), "label_%d", i);
+            atoms[i] = table.intern(name);
+        }
+        CHECK( table.size() == 5000 );
+        for (int i=0; i < 5000; i++) {
+            snprintf(name, sizeof(name), "label_%d", i);
+            REQUIRE( table.intern(name) == atoms[i] );
+            REQUIRE( atoms[i].view() == name );
+        }
+        CHECK( table.size() == 5000 );
+        CHECK( table.memory_used() > 5000 * 8 );
+    }
+
+    SECTION("Global table and threads") {
+        tinystd::atom seen[4][200];
+        std::thread threads[4];
+        for (int t=0; t < 4; t++) {
+            threads[t] = std::thread([t, &seen]() {
+                char name[32];
+                for (int i=0; i < 200; i++) {
+                    snprintf(name, sizeof(name), "shared.key.%d", (i * 7 + t) % 200);
+                    seen[t][(i * 7 + t) % 200] = tinystd::intern(name);
+                }
+            });
+        }
+        for (int t=0; t < 4; t++)
+            threads[t].join();
+        for (int i=0; i < 200; i++) {
+            for (int t=1; t < 4; t++)
+                REQUIRE( seen[t][i] == seen[0][i] );
+        }
+        CHECK( tinystd::intern("shared.key.5") == seen[2][5] );
+    }
+}
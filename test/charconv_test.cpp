@@ -0,0 +1,475 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <errno.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tinystl/charconv>
+#include <tinystl/string>
+
+template <class T>
+static tinystd::string format(T value, int base = 10)
+{
+    char buffer[80];
+    tinystd::to_chars_result r = tinystd::to_chars(buffer, buffer + sizeof(buffer), value, base);
+    if (r.ec != tinystd::errc::ok)
+        return tinystd::string("error");
+    return tinystd::string(buffer, r.ptr - buffer);
+}
+
+template <class T>
+static tinystd::string format_float(T value)
+{
+    char buffer[80];
+    tinystd::to_chars_result r = tinystd::to_chars(buffer, buffer + sizeof(buffer), value);
+    if (r.ec != tinystd::errc::ok)
+        return tinystd::string("error");
+    return tinystd::string(buffer, r.ptr - buffer);
+}
+
+template <class T>
+static tinystd::string format_float(T value, tinystd::chars_format fmt, int precision)
+{
+    char buffer[400];
+    tinystd::to_chars_result r = tinystd::to_chars(buffer, buffer + sizeof(buffer), value, fmt, precision);
+    if (r.ec != tinystd::errc::ok)
+        return tinystd::string("error");
+    return tinystd::string(buffer, r.ptr - buffer);
+}
+
+// Digits of the shortest %.*e output which reads back as v
+static int shortest_digits(double v, bool single)
+{
+    char text[40];
+    for (int p=1; p < 17; p++) {
+        snprintf(text, sizeof(text), "%.*e", p - 1, v);
+        if (single ? strtof(text, nullptr) == (float)v : strtod(text, nullptr) == v)
+            return p;
+    }
+    return 17;
+}
+
+// Significant digits of a formatted number
+static int significant_digits(const tinystd::string& s)
+{
+    int first = -1, last = -1;
+    for (int i=0; i < (int)s.length() && s[i] != 'e'; i++) {
+        if (s[i] >= '1' && s[i] <= '9') {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+    if (first < 0)
+        return 1;
+    int n = 0;
+    for (int i=first; i <= last; i++)
+        n += s[i] != '.';
+    return n;
+}
+
+static uint64_t random_bits(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+TEST_CASE("tinystl::charconv functions", "[tinystl::charconv]") {
+
+    SECTION("Integers to chars") {
+        CHECK( format(0) == "0" );
+        CHECK( format(7) == "7" );
+        CHECK( format(-7) == "-7" );
+        CHECK( format(10) == "10" );
+        CHECK( format(99) == "99" );
+        CHECK( format(100) == "100" );
+        CHECK( format(1234567) == "1234567" );
+        CHECK( format(INT_MAX) == "2147483647" );
+        CHECK( format(INT_MIN) == "-2147483648" );
+        CHECK( format(UINT_MAX) == "4294967295" );
+        CHECK( format(LLONG_MAX) == "9223372036854775807" );
+        CHECK( format(LLONG_MIN) == "-9223372036854775808" );
+        CHECK( format(ULLONG_MAX) == "18446744073709551615" );
+        CHECK( format((short)-12) == "-12" );
+        CHECK( format((unsigned char)200) == "200" );
+    }
+
+    SECTION("Digit counts") {
+        // Every power of ten and its predecessor, where the digit count changes
+        char expected[32];
+        unsigned long long p = 1;
+        for (int i=0; i < 20; i++) {
+            snprintf(expected, sizeof(expected), "%llu", p);
+            CHECK( format(p) == expected );
+            snprintf(expected, sizeof(expected), "%llu", p - 1);
+            CHECK( format(p - 1) == expected );
+            if (i < 19) p *= 10;
+        }
+    }
+
+    SECTION("Other bases") {
+        CHECK( format(255, 16) == "ff" );
+        CHECK( format(-255, 16) == "-ff" );
+        CHECK( format(5, 2) == "101" );
+        CHECK( format(35, 36) == "z" );
+        CHECK( format(0, 8) == "0" );
+        CHECK( format(ULLONG_MAX, 2) == tinystd::string(64, '1') );
+        CHECK( format(10, 1) == "error" );
+        CHECK( format(10, 37) == "error" );
+    }
+
+    SECTION("Buffer too small") {
+        char buffer[4] = { 'x', 'x', 'x', 'x' };
+        tinystd::to_chars_result r = tinystd::to_chars(buffer, buffer + 3, 12345);
+        CHECK( r.ec == tinystd::errc::value_too_large );
+        CHECK( r.ptr == buffer + 3 );
+
+        r = tinystd::to_chars(buffer, buffer + 3, 123);
+        CHECK( r.ec == tinystd::errc::ok );
+        CHECK( r.ptr == buffer + 3 );
+        CHECK( buffer[3] == 'x' );
+
+        r = tinystd::to_chars(buffer, buffer + 3, -123);
+        CHECK( r.ec == tinystd::errc::value_too_large );
+        r = tinystd::to_chars(buffer, buffer, 0);
+        CHECK( r.ec == tinystd::errc::value_too_large );
+    }
+
+    SECTION("to_string") {
+        CHECK( tinystd::to_string(0) == "0" );
+        CHECK( tinystd::to_string(-42) == "-42" );
+        CHECK( tinystd::to_string(INT_MIN) == "-2147483648" );
+        CHECK( tinystd::to_string(123456789L) == "123456789" );
+        CHECK( tinystd::to_string(LLONG_MIN) == "-9223372036854775808" );
+        CHECK( tinystd::to_string(4000000000U) == "4000000000" );
+        CHECK( tinystd::to_string(ULLONG_MAX) == "18446744073709551615" );
+        CHECK( tinystd::to_string(ULLONG_MAX).length() == 20 );
+    }
+
+    SECTION("Shortest floating point") {
+        CHECK( format_float(0.0) == "0" );
+        CHECK( format_float(-0.0) == "-0" );
+        CHECK( format_float(1.0) == "1" );
+        CHECK( format_float(-1.5) == "-1.5" );
+        CHECK( format_float(0.1) == "0.1" );
+        CHECK( format_float(0.3) == "0.3" );
+        CHECK( format_float(0.1 + 0.2) == "0.30000000000000004" );
+        CHECK( format_float(123.456) == "123.456" );
+        CHECK( format_float(1e23) == "1e+23" );
+        CHECK( format_float(1e21) == "1e+21" );
+        CHECK( format_float(123456789.0) == "123456789" );
+        CHECK( format_float(1e-7) == "1e-07" );
+        CHECK( format_float(0.001) == "0.001" );
+        CHECK( format_float(5e-324) == "5e-324" );
+        CHECK( format_float(DBL_MAX) == "1.7976931348623157e+308" );
+        CHECK( format_float(DBL_MIN) == "2.2250738585072014e-308" );
+        CHECK( format_float(9007199254740993.0) == "9007199254740992" );
+        CHECK( format_float(0.1f) == "0.1" );
+        CHECK( format_float(16777216.0f) == "16777216" );
+        CHECK( format_float(FLT_MAX) == "3.4028235e+38" );
+        CHECK( format_float(FLT_MIN) == "1.1754944e-38" );
+        CHECK( format_float(1e-45f) == "1e-45" );
+        CHECK( format_float((double)NAN) == "nan" );
+        CHECK( format_float(-INFINITY) == "-inf" );
+
+        char buffer[80];
+        CHECK( tinystd::to_chars(buffer, buffer + 80, 1e10, tinystd::chars_format::fixed).ptr - buffer == 11 );
+        CHECK( tinystd::to_chars(buffer, buffer + 80, 100.0, tinystd::chars_format::scientific).ptr - buffer == 5 );
+        tinystd::to_chars_result r = tinystd::to_chars(buffer, buffer + 80, 1.0, tinystd::chars_format::hex);
+        CHECK( tinystd::string(buffer, r.ptr - buffer) == "1p+0" );
+        r = tinystd::to_chars(buffer, buffer + 4, 0.30000000000000004);
+        CHECK( r.ec == tinystd::errc::value_too_large );
+    }
+
+    SECTION("Shortest round trip") {
+        // Random bit patterns cover all exponents, and the Grisu3 fallback
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        char buffer[80];
+        for (int i=0; i < 100000; i++) {
+            uint64_t bits = random_bits(state);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            if (!isfinite(d))
+                continue;
+            tinystd::to_chars_result r = tinystd::to_chars(buffer, buffer + sizeof(buffer), d);
+            REQUIRE( r.ec == tinystd::errc::ok );
+            *r.ptr = 0;
+            REQUIRE( strtod(buffer, nullptr) == d );
+            REQUIRE( significant_digits(buffer) == shortest_digits(d, false) );
+
+            uint32_t fbits = (uint32_t)bits;
+            float f;
+            memcpy(&f, &fbits, sizeof(f));
+            if (!isfinite(f))
+                continue;
+            r = tinystd::to_chars(buffer, buffer + sizeof(buffer), f);
+            REQUIRE( r.ec == tinystd::errc::ok );
+            *r.ptr = 0;
+            REQUIRE( strtof(buffer, nullptr) == f );
+            REQUIRE( significant_digits(buffer) == shortest_digits(f, true) );
+        }
+    }
+
+    SECTION("Fixed precision") {
+        using tinystd::chars_format;
+        CHECK( format_float(0.1, chars_format::fixed, 2) == "0.10" );
+        CHECK( format_float(1.005, chars_format::fixed, 2) == "1.00" );
+        CHECK( format_float(2.5, chars_format::fixed, 0) == "2" );
+        CHECK( format_float(9.996, chars_format::fixed, 2) == "10.00" );
+        CHECK( format_float(-0.0004, chars_format::fixed, 3) == "-0.000" );
+        CHECK( format_float(0.0, chars_format::scientific, 2) == "0.00e+00" );
+        CHECK( format_float(9.99, chars_format::scientific, 1) == "1.0e+01" );
+        CHECK( format_float(1e100, chars_format::fixed, 0) == "10000000000000000159028911097599180468360808563945281389781327557747838772170381060813469985856815104" );
+        CHECK( format_float(0.1, chars_format::fixed, 20) == "0.10000000000000000555" );
+        CHECK( format_float(1.0, chars_format::general, -1) == "1" );
+        // Precisions no buffer can hold fail early, general output stops changing
+        char small[32];
+        CHECK( tinystd::to_chars(small, small + 32, 1.0, chars_format::fixed, INT_MAX).ec == tinystd::errc::value_too_large );
+        CHECK( tinystd::to_chars(small, small + 32, 1.0, chars_format::scientific, INT_MAX).ec == tinystd::errc::value_too_large );
+        CHECK( format_float(0.5, chars_format::general, INT_MAX) == "0.5" );
+
+        // Against printf, which rounds the exact binary value
+        const char *formats[] = { "%.*f", "%.*e" };
+        const chars_format modes[] = { chars_format::fixed, chars_format::scientific };
+        uint64_t state = 0x2545f4914f6cdd1dULL;
+        char expected[400];
+        for (int i=0; i < 20000; i++) {
+            uint64_t bits = random_bits(state);
+            // Mostly moderate magnitudes, with short decimal expansions mixed in
+            double d = (double)(int64_t)(bits >> 20) / (1LL << (bits % 40));
+            if (i & 1)
+                d = (double)(bits % 100000) / 1000;
+            int precision = bits % 20;
+            for (int m=0; m < 2; m++) {
+                snprintf(expected, sizeof(expected), formats[m], precision, d);
+                REQUIRE( format_float(d, modes[m], precision) == expected );
+                snprintf(expected, sizeof(expected), formats[m], precision, (double)(float)d);
+                REQUIRE( format_float((float)d, modes[m], precision) == expected );
+            }
+        }
+    }
+
+    SECTION("Floating point to_string") {
+        CHECK( tinystd::to_string(0.5) == "0.5" );
+        CHECK( tinystd::to_string(-2.0f) == "-2" );
+        CHECK( tinystd::to_string(1e300) == "1e+300" );
+        CHECK( tinystd::to_string(3.14159, tinystd::chars_format::fixed, 2) == "3.14" );
+        CHECK( tinystd::to_string(1e300, tinystd::chars_format::fixed, 6).length() == 308 );
+        CHECK( tinystd::to_string(1.0, tinystd::chars_format::fixed, -1) == "1.000000" );
+        // Too long for a string, no overflow in the size estimate
+        CHECK( tinystd::to_string(1.0, tinystd::chars_format::fixed, INT_MAX).empty() );
+    }
+
+    SECTION("Integers from chars") {
+        const char *text = "12345678901234567890x";
+        unsigned long long ull = 0;
+        tinystd::from_chars_result r = tinystd::from_chars(text, text + strlen(text), ull);
+        CHECK( r.ec == tinystd::errc::ok );
+        CHECK( r.ptr == text + 20 );
+        CHECK( ull == 12345678901234567890ULL );
+
+        int i = 7;
+        r = tinystd::from_chars(text, text + strlen(text), i);
+        CHECK( r.ec == tinystd::errc::result_out_of_range );
+        CHECK( r.ptr == text + 20 );
+        CHECK( i == 7 );
+
+        text = "-2147483648";
+        r = tinystd::from_chars(text, text + strlen(text), i);
+        CHECK( r.ec == tinystd::errc::ok );
+        CHECK( i == INT_MIN );
+        text = "-2147483649";
+        CHECK( tinystd::from_chars(text, text + strlen(text), i).ec == tinystd::errc::result_out_of_range );
+
+        unsigned u = 5;
+        text = "-1";
+        r = tinystd::from_chars(text, text + 2, u);
+        CHECK( r.ec == tinystd::errc::invalid_argument );
+        CHECK( r.ptr == text );
+        text = " 1";
+        CHECK( tinystd::from_chars(text, text + 2, u).ec == tinystd::errc::invalid_argument );
+        text = "+1";
+        CHECK( tinystd::from_chars(text, text + 2, u).ec == tinystd::errc::invalid_argument );
+
+        text = "fFz";
+        r = tinystd::from_chars(text, text + 3, u, 16);
+        CHECK( u == 255 );
+        CHECK( r.ptr == text + 2 );
+        text = "18446744073709551616";
+        CHECK( tinystd::from_chars(text, text + strlen(text), ull).ec == tinystd::errc::result_out_of_range );
+        text = "000000000000000000000000018446744073709551615";
+        CHECK( tinystd::from_chars(text, text + strlen(text), ull).ec == tinystd::errc::ok );
+        CHECK( ull == ULLONG_MAX );
+
+        // The end of the range is respected by the eight digit steps
+        text = "123456789";
+        CHECK( tinystd::from_chars(text, text + 7, i).ptr == text + 7 );
+        CHECK( i == 1234567 );
+
+        char buffer[80];
+        uint64_t state = 0x853c49e6748fea9bULL;
+        for (int n=0; n < 10000; n++) {
+            long long v = (long long)random_bits(state) >> (n % 64);
+            int base = 2 + n % 35;
+            r.ptr = tinystd::to_chars(buffer, buffer + sizeof(buffer), v, base).ptr;
+            long long back = 0;
+            REQUIRE( tinystd::from_chars(buffer, (char *)r.ptr, back, base).ec == tinystd::errc::ok );
+            REQUIRE( back == v );
+        }
+    }
+
+    SECTION("Floating point from chars") {
+        double d = 0;
+        float f = 0;
+        const char *text = "1.5e3x";
+        tinystd::from_chars_result r = tinystd::from_chars(text, text + 6, d);
+        CHECK( d == 1500 );
+        CHECK( r.ptr == text + 5 );
+
+        text = "1e";
+        r = tinystd::from_chars(text, text + 2, d);
+        CHECK( d == 1 );
+        CHECK( r.ptr == text + 1 );
+        r = tinystd::from_chars(text, text + 2, d, tinystd::chars_format::scientific);
+        CHECK( r.ec == tinystd::errc::invalid_argument );
+        text = "2e5";
+        r = tinystd::from_chars(text, text + 3, d, tinystd::chars_format::fixed);
+        CHECK( d == 2 );
+        CHECK( r.ptr == text + 1 );
+
+        text = ".";
+        CHECK( tinystd::from_chars(text, text + 1, d).ec == tinystd::errc::invalid_argument );
+        text = ".25";
+        tinystd::from_chars(text, text + 3, d);
+        CHECK( d == 0.25 );
+        text = "-0";
+        tinystd::from_chars(text, text + 2, d);
+        CHECK( (d == 0 && signbit(d)) );
+
+        text = "-Infinity";
+        tinystd::from_chars(text, text + 9, d);
+        CHECK( d == -INFINITY );
+        text = "nan(123)";
+        r = tinystd::from_chars(text, text + 8, d);
+        CHECK( isnan(d) );
+        CHECK( r.ptr == text + 8 );
+
+        text = "1e400";
+        d = 3;
+        CHECK( tinystd::from_chars(text, text + 5, d).ec == tinystd::errc::result_out_of_range );
+        CHECK( d == 3 );
+        text = "1e-400";
+        CHECK( tinystd::from_chars(text, text + 6, d).ec == tinystd::errc::result_out_of_range );
+        text = "1e39";
+        CHECK( tinystd::from_chars(text, text + 4, f).ec == tinystd::errc::result_out_of_range );
+
+        text = "1.8p1";
+        tinystd::from_chars(text, text + 5, d, tinystd::chars_format::hex);
+        CHECK( d == 3 );
+
+        // Halfway cases need all digits
+        text = "9007199254740993";
+        tinystd::from_chars(text, text + strlen(text), d);
+        CHECK( d == 9007199254740992.0 );
+        text = "9007199254740993.0000000000000000000000000000001";
+        tinystd::from_chars(text, text + strlen(text), d);
+        CHECK( d == 9007199254740994.0 );
+        text = "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125e-324";
+        CHECK( tinystd::from_chars(text, text + strlen(text), d).ec == tinystd::errc::result_out_of_range );
+        text = "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125000000000000000000000000000000000000000000000000000000001e-324";
+        tinystd::from_chars(text, text + strlen(text), d);
+        CHECK( d == 5e-324 );
+    }
+
+    SECTION("Floating point parse against strtod") {
+        uint64_t state = 0x6a09e667f3bcc909ULL;
+        char buffer[80];
+        for (int i=0; i < 100000; i++) {
+            uint64_t bits = random_bits(state);
+            // Shortest output of random values, and random digit strings
+            // which are mostly not representable
+            int len;
+            if (i & 1) {
+                double v;
+                memcpy(&v, &bits, sizeof(v));
+                if (!isfinite(v))
+                    continue;
+                len = tinystd::to_chars(buffer, buffer + sizeof(buffer), v).ptr - buffer;
+            }
+            else {
+                int digits = 1 + bits % 30;
+                len = 0;
+                for (int n=0; n < digits; n++)
+                    buffer[len++] = '0' + random_bits(state) % 10;
+                len += snprintf(buffer + len, 16, "e%d", (int)(bits >> 32) % 700 - 350);
+            }
+            buffer[len] = 0;
+
+            double d = 0, expected = strtod(buffer, nullptr);
+            tinystd::from_chars_result r = tinystd::from_chars(buffer, buffer + len, d);
+            if (r.ec == tinystd::errc::ok)
+                REQUIRE( d == expected );
+            else
+                REQUIRE( (isinf(expected) || expected == 0) );
+            REQUIRE( r.ptr == buffer + len );
+
+            float f = 0, expected_f = strtof(buffer, nullptr);
+            r = tinystd::from_chars(buffer, buffer + len, f);
+            if (r.ec == tinystd::errc::ok)
+                REQUIRE( f == expected_f );
+            else
+                REQUIRE( (isinf(expected_f) || expected_f == 0) );
+        }
+    }
+
+    SECTION("sto functions") {
+        int idx = -1;
+        CHECK( tinystd::stoi(tinystd::string("  -42abc"), &idx) == -42 );
+        CHECK( idx == 5 );
+        CHECK( tinystd::stoi(tinystd::string("+7")) == 7 );
+        CHECK( tinystd::stol(tinystd::string("0x1f"), &idx, 16) == 31 );
+        CHECK( idx == 4 );
+        CHECK( tinystd::stol(tinystd::string("0x1f"), &idx, 0) == 31 );
+        CHECK( tinystd::stol(tinystd::string("017"), &idx, 0) == 15 );
+        CHECK( tinystd::stol(tinystd::string("0xg"), &idx, 16) == 0 );
+        CHECK( idx == 1 );
+        CHECK( tinystd::stoul(tinystd::string("-1")) == ULONG_MAX );
+        CHECK( tinystd::stoull(tinystd::string("18446744073709551615")) == ULLONG_MAX );
+        CHECK( tinystd::stoll(tinystd::string("-9223372036854775808")) == LLONG_MIN );
+
+        errno = 0;
+        CHECK( tinystd::stoi(tinystd::string("abc"), &idx) == 0 );
+        CHECK( idx == 0 );
+        CHECK( errno == EINVAL );
+        errno = 0;
+        CHECK( tinystd::stoi(tinystd::string("99999999999")) == INT_MAX );
+        CHECK( errno == ERANGE );
+        errno = 0;
+        CHECK( tinystd::stoll(tinystd::string("-99999999999999999999")) == LLONG_MIN );
+        CHECK( errno == ERANGE );
+
+        CHECK( tinystd::stod(tinystd::string(" 3.25xyz"), &idx) == 3.25 );
+        CHECK( idx == 5 );
+        CHECK( tinystd::stod(tinystd::string("-0x1.8p1")) == -3 );
+        CHECK( tinystd::stof(tinystd::string("+1e-3")) == 1e-3f );
+        CHECK( tinystd::stod(tinystd::string("--1"), &idx) == 0 );
+        CHECK( idx == 0 );
+        errno = 0;
+        CHECK( tinystd::stod(tinystd::string("-1e999")) == -HUGE_VAL );
+        CHECK( errno == ERANGE );
+    }
+}
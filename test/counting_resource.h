@@ -0,0 +1,28 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef _TEST_COUNTING_RESOURCE_H
+#define _TEST_COUNTING_RESOURCE_H
+
+#include <tinystl/memory_resource>
+
+// Resource counting the live blocks it handed out
+class counting_resource : public tinystd::memory_resource {
+public:
+    counting_resource() : live(0), total(0) {}
+    int live;
+    int total;
+
+protected:
+    void * do_allocate(size_t bytes, size_t alignment) override { live++; total++; return tinystd::new_delete_resource()->allocate(bytes, alignment); }
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override { live--; tinystd::new_delete_resource()->deallocate(p, bytes, alignment); }
+    bool do_is_equal(const tinystd::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+#endif // _TEST_COUNTING_RESOURCE_H
@@ -10,6 +10,7 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <thread>
 #include <tinystl/list>
 #include <tinystl/string>
 
@@ -130,6 +131,43 @@ TEST_CASE("tinystl::list class", "[tinystl::list]") {
         }
     }
 
+    SECTION("Node allocation") {
+        tinystd::list<tinystd::string> queue;
+
+        for (int i=0; i < 1000; i++) queue.push_back(tinystd::to_string(i));
+        CHECK( queue.size() == 1000 );
+
+        // Nodes released by pop_front are reused by the following push_back
+        const tinystd::string *first = &queue.front();
+        queue.pop_front();
+        queue.push_back("last");
+        CHECK( &queue.back() == first );
+        CHECK( queue.back() == "last" );
+
+        int i = 1;
+        for (auto it = queue.begin(); it != queue.end() && i < 1000; ++it, ++i) {
+            CHECK( *it == tinystd::to_string(i) );
+        }
+
+        queue.clear();
+        CHECK( queue.empty() );
+    }
+
+    SECTION("Cross-thread free") {
+        tinystd::list<int> *shared = new tinystd::list<int>;
+        for (int i=0; i < 1000; i++) shared->push_back(i);
+
+        // Nodes go back to the producing thread through its remote queue
+        std::thread consumer([shared]() { delete shared; });
+        consumer.join();
+
+        tinystd::list<int> again;
+        for (int i=0; i < 1000; i++) again.push_back(i);
+        CHECK( again.size() == 1000 );
+        CHECK( again.front() == 0 );
+        CHECK( again.back() == 999 );
+    }
+
     SECTION("Element access") {
         {
             tinystd::list<int> mylist;
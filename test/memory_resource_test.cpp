@@ -0,0 +1,121 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <tinystl/memory_resource>
+#include <tinystl/vector>
+#include <tinystl/list>
+#include <tinystl/string>
+
+#include "counting_resource.h"
+
+TEST_CASE("tinystl::memory_resource class", "[tinystl::memory_resource]") {
+
+    SECTION("Default resource") {
+        counting_resource res;
+
+        CHECK( tinystd::get_default_resource() == tinystd::new_delete_resource() );
+        tinystd::memory_resource *old = tinystd::set_default_resource(&res);
+        CHECK( old == tinystd::new_delete_resource() );
+
+        {
+            tinystd::pmr::vector<int> v;
+            v.push_back(1);
+            CHECK( res.live == 1 );
+        }
+        CHECK( res.live == 0 );
+
+        tinystd::set_default_resource(nullptr);
+        CHECK( tinystd::get_default_resource() == tinystd::new_delete_resource() );
+    }
+
+    SECTION("Over-aligned allocation") {
+        tinystd::memory_resource *r = tinystd::new_delete_resource();
+        void *p = r->allocate(100, 64);
+        REQUIRE( p != nullptr );
+        CHECK( ((uintptr_t)p & 63) == 0 );
+        memset(p, 0x55, 100);
+        r->deallocate(p, 100, 64);
+    }
+
+    SECTION("pmr::vector") {
+        counting_resource r1, r2;
+        {
+            tinystd::pmr::vector<tinystd::string> v1(&r1);
+            v1.push_back("one");
+            v1.push_back("two");
+            CHECK( r1.live == 1 );
+
+            // Same resource, the buffer is taken over
+            tinystd::pmr::vector<tinystd::string> v2(std::move(v1), &r1);
+            CHECK( r1.total == 1 );
+            CHECK( v2.size() == 2 );
+            CHECK( v1.size() == 0 );
+
+            // Different resource, elements are moved into its own buffer
+            tinystd::pmr::vector<tinystd::string> v3(&r2);
+            v3 = std::move(v2);
+            CHECK( r2.live == 1 );
+            CHECK( v3.get_allocator().resource() == &r2 );
+            CHECK( v3.size() == 2 );
+            CHECK( v3[0] == "one" );
+            CHECK( v3[1] == "two" );
+
+            tinystd::pmr::vector<tinystd::string> v4(v3, &r1);
+            CHECK( v4[1] == "two" );
+            CHECK( r1.live == 2 );
+        }
+        CHECK( r1.live == 0 );
+        CHECK( r2.live == 0 );
+    }
+
+    SECTION("pmr::list") {
+        counting_resource res;
+        {
+            tinystd::pmr::list<int> l(&res);
+            for (int i=0; i < 10; i++) l.push_back(i);
+            CHECK( res.live == 10 );
+            l.pop_front();
+            CHECK( res.live == 9 );
+        }
+        CHECK( res.live == 0 );
+    }
+
+    SECTION("pmr::string") {
+        counting_resource res;
+        {
+            tinystd::pmr::string s("pooled", &res);
+            CHECK( res.live == 0 );
+            s += " string, long enough for the heap";
+            CHECK( s == "pooled string, long enough for the heap" );
+            CHECK( res.live == 1 );
+
+            tinystd::pmr::string t = s + "!";
+            CHECK( t == "pooled string, long enough for the heap!" );
+            CHECK( t.get_allocator() == s.get_allocator() );
+            CHECK( res.live == 2 );
+        }
+        CHECK( res.live == 0 );
+    }
+
+    SECTION("monotonic_buffer_resource") {
+        tinystd::monotonic_buffer_resource mono;
+        tinystd::pmr::vector<int> v(&mono);
+
+        for (int i=0; i < 1000; i++) v.push_back(i);
+        CHECK( v[999] == 999 );
+        CHECK( v.get_allocator() == tinystd::polymorphic_allocator<int>(&mono) );
+        CHECK( v.get_allocator() != tinystd::polymorphic_allocator<int>() );
+    }
+}
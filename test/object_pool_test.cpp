@@ -0,0 +1,124 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <tinystl/object_pool>
+#include <tinystl/arena>
+
+struct message {
+    static int alive;
+
+    int id;
+    double payload[4];
+
+    message(int i, double p) : id(i) { for (int k=0; k < 4; k++) payload[k] = p; alive++; }
+    ~message() { alive--; }
+};
+
+int message::alive = 0;
+
+struct alignas(64) wide_message {
+    char data[40];
+};
+
+TEST_CASE("tinystl::object_pool class", "[tinystl::object_pool]") {
+
+    SECTION("Create and destroy") {
+        tinystd::object_pool<message> pool(4);
+
+        message *m1 = pool.create(1, 1.5);
+        message *m2 = pool.create(2, 2.5);
+        REQUIRE( m1 != nullptr );
+        REQUIRE( m2 != nullptr );
+        CHECK( m1->id == 1 );
+        CHECK( m2->payload[3] == 2.5 );
+        CHECK( message::alive == 2 );
+        CHECK( pool.size() == 2 );
+        CHECK( pool.capacity() == 4 );
+
+        pool.destroy(m1);
+        pool.destroy(m2);
+        CHECK( message::alive == 0 );
+        CHECK( pool.size() == 0 );
+    }
+
+    SECTION("Storage reuse") {
+        tinystd::object_pool<message> pool(4);
+
+        message *m1 = pool.create(1, 0.0);
+        pool.destroy(m1);
+        // Most recently freed slot comes back first
+        message *m2 = pool.create(2, 0.0);
+        CHECK( m2 == m1 );
+        CHECK( m2->id == 2 );
+        pool.destroy(m2);
+    }
+
+    SECTION("Growth") {
+        tinystd::object_pool<message> pool(3);
+        message *m[10];
+
+        for (int i=0; i < 10; i++) {
+            m[i] = pool.create(i, (double)i);
+            REQUIRE( m[i] != nullptr );
+        }
+        CHECK( pool.size() == 10 );
+        CHECK( pool.capacity() >= 10 );
+        for (int i=0; i < 10; i++) {
+            CHECK( m[i]->id == i );
+            pool.destroy(m[i]);
+        }
+        CHECK( message::alive == 0 );
+    }
+
+    SECTION("Bulk preallocation") {
+        tinystd::object_pool<message> pool(2);
+
+        CHECK( pool.reserve(100) );
+        CHECK( pool.capacity() == 100 );
+        CHECK( pool.available() == 100 );
+
+        // All slots come from the single reserved chunk, in address order
+        message *first = pool.create(0, 0.0);
+        message *prev = first;
+        for (int i=1; i < 100; i++) {
+            message *m = pool.create(i, 0.0);
+            CHECK( m == prev + 1 );
+            prev = m;
+        }
+        CHECK( pool.capacity() == 100 );
+        CHECK( pool.available() == 0 );
+
+        CHECK( pool.reserve(50) );
+        CHECK( pool.capacity() == 100 );
+    }
+
+    SECTION("Over-aligned objects") {
+        tinystd::object_pool<wide_message> pool(5);
+
+        for (int i=0; i < 12; i++) {
+            wide_message *m = pool.create();
+            REQUIRE( m != nullptr );
+            CHECK( ((uintptr_t)m & 63) == 0 );
+        }
+    }
+
+    SECTION("Arena storage") {
+        tinystd::arena a;
+        tinystd::arena_allocator<message> alloc(a);
+        tinystd::object_pool<message, tinystd::arena_allocator<message> > pool(16, alloc);
+
+        message *m = pool.create(7, 7.0);
+        CHECK( m->id == 7 );
+        CHECK( a.used() >= sizeof(message) * 16 );
+        pool.destroy(m);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <tinystl/rope>
+
+static std::string flatten(const tinystd::rope& r)
+{
+    std::string s;
+    r.for_each_chunk([&s](tinystd::string_view v) { s.append(v.data(), v.size()); });
+    return s;
+}
+
+TEST_CASE("tinystl::rope class", "[tinystl::rope]") {
+
+    SECTION("Construction and access") {
+        tinystd::rope empty;
+        CHECK( empty.empty() );
+        CHECK( empty.size() == 0 );
+        CHECK( empty.str() == "" );
+
+        tinystd::rope r("hello world");
+        CHECK( r.size() == 11 );
+        CHECK( r[4] == 'o' );
+        CHECK( r[11] == 0 );
+        CHECK( r.str() == "hello world" );
+
+        std::string big(100000, 'x');
+        for (size_t i=0; i < big.size(); i++)
+            big[i] = 'a' + i % 26;
+        tinystd::rope b(tinystd::string_view(big.c_str(), big.size()));
+        CHECK( b.size() == 100000 );
+        CHECK( b[99999] == big[99999] );
+        CHECK( flatten(b) == big );
+        // Full leaves under a balanced tree
+        CHECK( b.height() <= 8 );
+    }
+
+    SECTION("Edits") {
+        tinystd::rope r("hello world");
+        CHECK( r.insert(5, ",") );
+        CHECK( r.str() == "hello, world" );
+        CHECK( r.append("!") );
+        CHECK( r.str() == "hello, world!" );
+        CHECK( r.erase(0, 7) );
+        CHECK( r.str() == "world!" );
+        CHECK( r.replace(0, 5, "there") );
+        CHECK( r.str() == "there!" );
+        CHECK( r.erase(3) );
+        CHECK( r.str() == "the" );
+        CHECK( !r.insert(4, "x") );
+        CHECK( !r.erase(-1) );
+        CHECK( r.str() == "the" );
+    }
+
+    SECTION("Sharing") {
+        std::string text(5000, '.');
+        tinystd::rope a(tinystd::string_view(text.c_str(), text.size()));
+        tinystd::rope b(a);
+        CHECK( b.insert(2500, "middle") );
+        CHECK( a.size() == 5000 );
+        CHECK( b.size() == 5006 );
+        CHECK( b.substr(2500, 6).str() == "middle" );
+        CHECK( a.substr(4998).str() == ".." );
+        CHECK( a.substr(6000).empty() );
+
+        tinystd::rope c = a;
+        c += b;
+        CHECK( c.size() == 10006 );
+        CHECK( c.substr(7500, 6).str() == "middle" );
+        c.clear();
+        CHECK( c.empty() );
+        CHECK( b.size() == 5006 );
+    }
+
+    SECTION("Random edits against std::string") {
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        auto next = [&state]() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        std::string ref;
+        tinystd::rope r;
+        char text[2000];
+        for (int i=0; i < 3000; i++) {
+            int pos = ref.empty() ? 0 : next() % (ref.size() + 1);
+            int len = next() % ((i % 10 == 0) ? 2000 : 20);
+            for (int k=0; k < len; k++)
+                text[k] = 'a' + next() % 26;
+
+            switch (next() % 4) {
+                case 0:
+                case 1:
+                    REQUIRE( r.insert(pos, tinystd::string_view(text, len)) );
+                    ref.insert(pos, text, len);
+                    break;
+                case 2:
+                    REQUIRE( r.erase(pos, len) );
+                    ref.erase(pos, len);
+                    break;
+                case 3:
+                    REQUIRE( r.replace(pos, len, tinystd::string_view(text, len / 2)) );
+                    ref.replace(pos, len, text, len / 2);
+                    break;
+            }
+            REQUIRE( r.size() == (int)ref.size() );
+            if (!ref.empty())
+                REQUIRE( r[pos % ref.size()] == ref[pos % ref.size()] );
+        }
+        CHECK( flatten(r) == ref );
+        CHECK( std::string(r.str().c_str()) == ref );
+
+        // AVL height bound over the number of leaves
+        int leaves = 0;
+        r.for_each_chunk([&leaves](tinystd::string_view) { leaves++; });
+        int bound = 2;
+        for (int n=1; n < leaves; n *= 2)
+            bound += 2;
+        CHECK( r.height() <= bound );
+    }
+}
@@ -0,0 +1,151 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <string.h>
+#include <thread>
+#include <tinystl/shared_string>
+#include <tinystl/memory_resource>
+
+#include "counting_resource.h"
+
+typedef tinystd::basic_shared_string<char, tinystd::polymorphic_allocator<char> > pmr_shared_string;
+
+static tinystd::shared_string pass_by_value(tinystd::shared_string s)
+{
+    return s;
+}
+
+TEST_CASE("tinystl::shared_string class", "[tinystl::shared_string]") {
+
+    SECTION("Construction") {
+        tinystd::shared_string empty;
+        CHECK( empty.empty() );
+        CHECK( empty.c_str()[0] == 0 );
+        CHECK( empty.use_count() == 0 );
+
+        tinystd::shared_string s("payload");
+        CHECK( s.size() == 7 );
+        CHECK( strcmp(s.c_str(), "payload") == 0 );
+        CHECK( s == "payload" );
+        CHECK( s[3] == 'l' );
+        CHECK( s[7] == 0 );
+
+        tinystd::string str("from string");
+        tinystd::shared_string t(str);
+        CHECK( t.str() == str );
+        CHECK( t.view() == "from string" );
+    }
+
+    SECTION("Copies share the buffer") {
+        tinystd::shared_string a("a large payload");
+        tinystd::shared_string b = a;
+        tinystd::shared_string c = pass_by_value(b);
+        CHECK( a.c_str() == b.c_str() );
+        CHECK( c.c_str() == a.c_str() );
+        CHECK( a.use_count() == 3 );
+        CHECK( a == c );
+
+        c.clear();
+        CHECK( a.use_count() == 2 );
+        tinystd::shared_string d(std::move(b));
+        CHECK( b.empty() );
+        CHECK( a.use_count() == 2 );
+    }
+
+    SECTION("Modification detaches") {
+        tinystd::shared_string a("hello");
+        tinystd::shared_string b = a;
+
+        CHECK( b.append(" world") );
+        CHECK( a == "hello" );
+        CHECK( b == "hello world" );
+        CHECK( a.c_str() != b.c_str() );
+        CHECK( a.use_count() == 1 );
+        CHECK( b.use_count() == 1 );
+
+        // Unshared buffers are modified in place
+        CHECK( b.reserve(64) );
+        const char *before = b.c_str();
+        CHECK( b.insert(5, ",") );
+        CHECK( b.erase(0, 7) );
+        CHECK( b.replace(0, 5, "there") );
+        b += '!';
+        CHECK( b == "there!" );
+        CHECK( b.c_str() == before );
+
+        tinystd::shared_string c = b;
+        char *p = c.mutable_data();
+        p[0] = 'T';
+        CHECK( c == "There!" );
+        CHECK( b == "there!" );
+
+        CHECK( c.resize(8, '?') );
+        CHECK( c == "There!??" );
+        CHECK( c.resize(3) );
+        CHECK( c == "The" );
+        CHECK( !c.insert(4, "x") );
+        CHECK( c.substr(1) == "he" );
+    }
+
+    SECTION("Appending from itself") {
+        tinystd::shared_string a("abc");
+        CHECK( a.append(a.view()) );
+        CHECK( a == "abcabc" );
+        CHECK( a.insert(1, a.view().substr(3, 2)) );
+        CHECK( a == "aabbcabc" );
+    }
+
+    SECTION("Allocator follows the buffer") {
+        counting_resource r1, r2;
+        {
+            pmr_shared_string a("first", &r1);
+            pmr_shared_string b("second", &r2);
+            pmr_shared_string c(&r2);
+
+            a.swap(b);
+            CHECK( a.get_allocator().resource() == &r2 );
+            CHECK( b.get_allocator().resource() == &r1 );
+
+            c = b;
+            CHECK( c.get_allocator().resource() == &r1 );
+            CHECK( c.use_count() == 2 );
+            c = std::move(a);
+            CHECK( c == "second" );
+            CHECK( c.get_allocator().resource() == &r2 );
+            CHECK( r1.live == 1 );
+            CHECK( r2.live == 1 );
+        }
+        CHECK( r1.live == 0 );
+        CHECK( r2.live == 0 );
+    }
+
+    SECTION("Threads") {
+        tinystd::shared_string shared(tinystd::string(10000, 'x'));
+        std::thread threads[4];
+        int ok[4] = { 0, 0, 0, 0 };
+        for (int t=0; t < 4; t++) {
+            threads[t] = std::thread([t, &shared, &ok]() {
+                for (int i=0; i < 1000; i++) {
+                    tinystd::shared_string copy = shared;
+                    if (i % 10 == 0)
+                        copy.push_back('y');
+                    ok[t] += copy.size() >= 10000 && copy[0] == 'x';
+                }
+            });
+        }
+        for (int t=0; t < 4; t++)
+            threads[t].join();
+        for (int t=0; t < 4; t++)
+            CHECK( ok[t] == 1000 );
+        CHECK( shared.use_count() == 1 );
+    }
+}
@@ -10,7 +10,32 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <thread>
 #include <tinystl/string>
+#include <tinystl/vector>
+
+typedef tinystd::basic_string<char, tinystd::allocator<char, tinystd::cached_policy> > cached_string;
+
+static bool late_intact;
+static bool late_returned;
+
+// Thread-local constructed before the thread cache, so it is destroyed after
+// the cache and frees its string past the cache teardown
+struct late_string {
+    cached_string s;
+
+    ~late_string()
+    {
+        late_intact = s == "a string too long for the local buffer";
+        tinystd::memory_statistics before = tinystd::memory_stats();
+        {
+            cached_string t;
+            t.swap(s);
+        }
+        tinystd::memory_statistics after = tinystd::memory_stats();
+        late_returned = after.frees == before.frees + 1;
+    }
+};
 
 TEST_CASE("tinystl::string class", "[tinystl::string]") {
 
@@ -93,6 +118,185 @@ TEST_CASE("tinystl::string class", "[tinystl::string]") {
         CHECK( str == "I like to code" );
     }
 
+    SECTION("Large buffers") {
+        // Above TINYSTD_MMAP_THRESHOLD the buffer is mapped and grown in place of a copy
+        tinystd::string str(TINYSTD_MMAP_THRESHOLD + 100, 'a');
+        str[10] = 'b';
+        str.append(TINYSTD_MMAP_THRESHOLD, 'c');
+
+        CHECK( str.length() == 2 * TINYSTD_MMAP_THRESHOLD + 100 );
+        CHECK( str[9] == 'a' );
+        CHECK( str[10] == 'b' );
+        CHECK( str[TINYSTD_MMAP_THRESHOLD + 99] == 'a' );
+        CHECK( str[TINYSTD_MMAP_THRESHOLD + 100] == 'c' );
+        CHECK( str[str.length() - 1] == 'c' );
+    }
+
+    SECTION("Growing buffers") {
+        // Buffers are grown in place or moved by the allocator
+        tinystd::string str;
+        for (int i=0; i < 2000; i++) str.append(1, 'a' + i % 26);
+
+        bool ok = str.length() == 2000;
+        for (int i=0; i < 2000; i++) {
+            if (str[i] != 'a' + i % 26) ok = false;
+        }
+        CHECK( ok );
+        CHECK( str.c_str()[2000] == 0 );
+    }
+
+    SECTION("Geometric growth") {
+        // Appending one character at a time reallocates a logarithmic number of times
+        tinystd::string str;
+        int capacity = str.capacity();
+        int changes = 0;
+        for (int i=0; i < 100000; i++) {
+            str += 'x';
+            if (str.capacity() != capacity) {
+                CHECK( str.capacity() >= capacity + capacity / 2 );
+                capacity = str.capacity();
+                changes++;
+            }
+        }
+        CHECK( str.length() == 100000 );
+        CHECK( changes < 40 );
+
+        // Exact requests are not rounded up geometrically
+        tinystd::string r;
+        r.reserve(1000);
+        CHECK( r.capacity() >= 1001 );
+        CHECK( r.capacity() < 1100 );
+        r.assign(1500, 'y');
+        CHECK( r.capacity() < 1600 );
+    }
+
+    SECTION("Short strings") {
+        // Up to 15 characters are kept in the object, without allocation
+        tinystd::string empty;
+        CHECK( empty.c_str()[0] == 0 );
+
+        tinystd::string s("identifier");
+        const char *local = s.c_str();
+        CHECK( (local >= (const char *)&s && local < (const char *)(&s + 1)) );
+
+        s += "_12345";
+        CHECK( s == "identifier_12345" );
+        CHECK( s.c_str() != local );
+        s.erase(10);
+        CHECK( s == "identifier" );
+
+        // Moving a local string copies the characters along
+        tinystd::string m(std::move(s));
+        CHECK( m == "identifier" );
+        CHECK( s.empty() );
+        CHECK( s.c_str()[0] == 0 );
+
+        tinystd::string l("a string which is far too long to stay local");
+        m.swap(l);
+        CHECK( m == "a string which is far too long to stay local" );
+        CHECK( l == "identifier" );
+        l = std::move(m);
+        CHECK( l == "a string which is far too long to stay local" );
+
+        // Appending a string to itself across the local limit
+        tinystd::string twice("0123456789");
+        twice += twice;
+        CHECK( twice == "01234567890123456789" );
+
+        tinystd::vector<tinystd::string> v;
+        for (int i=0; i < 100; i++) v.push_back(i % 2 ? "short" : "a rather longer string value");
+        CHECK( v[98] == "a rather longer string value" );
+        CHECK( v[99] == "short" );
+    }
+
+    SECTION("Searching") {
+        tinystd::string str("There are two needles in this haystack with needles.");
+
+        CHECK( str.find("needle") == 14 );
+        CHECK( str.find("needle", 15) == 44 );
+        CHECK( str.find("needles are small", 0, 6) == 14 );
+        CHECK( str.find('T') == 0 );
+        CHECK( str.find("") == 0 );
+        CHECK( str.find("nothing") == tinystd::string::npos );
+        CHECK( str.rfind("needle") == 44 );
+        CHECK( str.rfind("needle", 43) == 14 );
+        CHECK( str.rfind('e') == 49 );
+        CHECK( str.find_first_of("aeiou") == 2 );
+        CHECK( str.find_first_of("aeiou", 5) == 6 );
+        CHECK( str.find_last_of("aeiou") == 49 );
+        CHECK( str.find_first_not_of("Ther ") == 6 );
+        CHECK( str.find_last_not_of(".s") == 49 );
+        CHECK( str.find_last_not_of(".des", 51) == 48 );
+        CHECK( str.find_first_of(tinystd::string("xyz")) == 32 );
+        CHECK( str.find_first_of("") == tinystd::string::npos );
+
+        tinystd::wstring w(L"wide wide world");
+        CHECK( w.find(L"wide", 1) == 5 );
+        CHECK( w.rfind(L'w') == 10 );
+        CHECK( w.find_first_not_of(L"diew ") == 11 );
+        CHECK( w.find_last_of(L"xyz") == tinystd::wstring::npos );
+    }
+
+    SECTION("Searching long strings") {
+        // Compares all search functions with std::string over inputs longer
+        // than the vector blocks, with matches at every alignment
+        unsigned seed = 12345;
+        for (int round=0; round < 200; round++) {
+            int len = round % 150;
+            std::string ref;
+            for (int i=0; i < len; i++) {
+                seed = seed * 1103515245 + 12345;
+                ref += "abcd\xe9\x80 "[(seed >> 16) % 7];
+            }
+            tinystd::string str(ref.c_str(), len);
+
+            const char *needles[] = { "a", "ab", "dcb", "abcab", " \x80", "" };
+            const char *sets[] = { "a", "bd", " \xe9", "abcd", "abcd\xe9\x80 ", "" };
+            for (int k=0; k < 6; k++) {
+                for (int pos = -1; pos <= len + 1; pos += 7) {
+                    size_t p = pos < 0 ? std::string::npos : (size_t)pos;
+                    int n = (int)strlen(needles[k]);
+                    int found = str.find(needles[k], pos < 0 ? 0 : pos);
+                    size_t expected = ref.find(needles[k], pos < 0 ? 0 : p);
+                    CHECK( found == (expected == std::string::npos ? -1 : (int)expected) );
+                    found = str.rfind(needles[k], pos, n);
+                    expected = ref.rfind(needles[k], p, n);
+                    CHECK( found == (expected == std::string::npos ? -1 : (int)expected) );
+
+                    found = str.find_first_of(sets[k], pos < 0 ? 0 : pos);
+                    expected = ref.find_first_of(sets[k], pos < 0 ? 0 : p);
+                    CHECK( found == (expected == std::string::npos ? -1 : (int)expected) );
+                    found = str.find_first_not_of(sets[k], pos < 0 ? 0 : pos);
+                    expected = ref.find_first_not_of(sets[k], pos < 0 ? 0 : p);
+                    CHECK( found == (expected == std::string::npos ? -1 : (int)expected) );
+                    found = str.find_last_of(sets[k], pos);
+                    expected = ref.find_last_of(sets[k], p);
+                    CHECK( found == (expected == std::string::npos ? -1 : (int)expected) );
+                    found = str.find_last_not_of(sets[k], pos);
+                    expected = ref.find_last_not_of(sets[k], p);
+                    CHECK( found == (expected == std::string::npos ? -1 : (int)expected) );
+                }
+            }
+        }
+    }
+
+    SECTION("Character types") {
+        tinystd::wstring w(L"wide");
+        w += L" string";
+        CHECK( w == L"wide string" );
+        CHECK( w.length() == 11 );
+
+        tinystd::u16string u(u"utf");
+        u.append(2, u'-');
+        u += u"16";
+        CHECK( u == u"utf--16" );
+        CHECK( u < u"utf-8" );
+
+        tinystd::u32string e;
+        CHECK( e.empty() );
+        CHECK( e == U"" );
+    }
+
     SECTION("Element access") {
         char str_contents[] = "Test string";
         tinystd::string str(str_contents);
@@ -188,6 +392,20 @@ TEST_CASE("tinystl::string class", "[tinystl::string]") {
             CHECK ( str == "to be, or not to be: that is the question..." );
         }
 
+        {
+            // Inserting parts of a string into itself
+            tinystd::string str("abcdef");
+            str.insert(0, str.view());
+            CHECK( str == "abcdefabcdef" );
+            str.insert(3, str.view().substr(1, 4));
+            CHECK( str == "abcbcdedefabcdef" );
+            str.insert(4, str.view().substr(8, 3));
+            CHECK( str == "abcbefacdedefabcdef" );
+            str.reserve(100);
+            str.insert(2, str.view().substr(0, 5));
+            CHECK( str == "ababcbecbefacdedefabcdef" );
+        }
+
         {
             tinystd::string str ("This is an example sentence.");
 
@@ -238,5 +456,20 @@ TEST_CASE("tinystl::string class", "[tinystl::string]") {
         }
     }
 
+    SECTION("Freed after the thread cache") {
+        late_intact = false;
+        late_returned = false;
+        std::thread t([]() {
+            static thread_local late_string late;
+            late.s = "a string too long for the local buffer";
+        });
+        t.join();
+        CHECK( late_intact );
+#if TINYSTD_ALLOCATOR_POLICY != TINYSTD_POLICY_FAST && TINYSTD_ALLOCATOR_POLICY != TINYSTD_POLICY_RUNTIME && TINYSTD_MEMORY_STATS
+        // The block went back to the base policy, not into the dead cache
+        CHECK( late_returned );
+#endif
+    }
+
 
 }
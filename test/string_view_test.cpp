@@ -0,0 +1,144 @@
+/*
+    Copyright © 2020 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <tinystl/string_view>
+#include <tinystl/string>
+
+TEST_CASE("tinystl::string_view class", "[tinystl::string_view]") {
+
+    SECTION("Construction") {
+        tinystd::string_view empty;
+        CHECK( empty.empty() );
+        CHECK( empty.size() == 0 );
+        CHECK( empty.data() != nullptr );
+
+        tinystd::string_view v("Hello, world");
+        CHECK( v.size() == 12 );
+        CHECK( v[4] == 'o' );
+        CHECK( v.front() == 'H' );
+        CHECK( v.back() == 'd' );
+        CHECK( v.at(100) == 0 );
+
+        const char buffer[] = { 'a', 'b', 0, 'c' };
+        tinystd::string_view b(buffer, 4);
+        CHECK( b.size() == 4 );
+        CHECK( b[3] == 'c' );
+    }
+
+    SECTION("Substrings") {
+        const char *text = "key=value;other=thing";
+        tinystd::string_view v(text);
+
+        tinystd::string_view key = v.substr(0, v.find('='));
+        CHECK( key == "key" );
+        CHECK( key.data() == text );
+
+        tinystd::string_view rest = v.substr(v.find(';') + 1);
+        CHECK( rest == "other=thing" );
+        CHECK( rest.data() == text + 10 );
+        CHECK( v.substr(100).empty() );
+        CHECK( v.substr(4, 100) == "value;other=thing" );
+
+        rest.remove_prefix(6);
+        rest.remove_suffix(2);
+        CHECK( rest == "thi" );
+
+        char out[8] = { 0 };
+        CHECK( v.copy(out, 5, 4) == 5 );
+        CHECK( tinystd::string_view(out) == "value" );
+    }
+
+    SECTION("Comparisons") {
+        tinystd::string_view a("apple");
+        tinystd::string_view b("apples");
+
+        CHECK( a.compare(b) < 0 );
+        CHECK( b.compare(a) > 0 );
+        CHECK( a.compare("apple") == 0 );
+        CHECK( b.compare(0, 5, a) == 0 );
+        CHECK( b.compare(1, 3, "pple", 3) == 0 );
+        CHECK( a < b );
+        CHECK( b > a );
+        CHECK( a != b );
+        CHECK( "apple" == a );
+        CHECK( a <= "apple" );
+        CHECK( a.starts_with("app") );
+        CHECK( b.ends_with("les") );
+        CHECK( !a.ends_with("apples") );
+
+        // Embedded zeros take part
+        tinystd::string_view z1("a\0b", 3);
+        tinystd::string_view z2("a\0c", 3);
+        CHECK( z1 < z2 );
+        CHECK( z1 != tinystd::string_view("a") );
+    }
+
+    SECTION("Searching") {
+        tinystd::string_view v("one two three two one");
+
+        CHECK( v.find("two") == 4 );
+        CHECK( v.rfind("two") == 14 );
+        CHECK( v.find_first_of("wt") == 4 );
+        CHECK( v.find_last_of("wt") == 15 );
+        CHECK( v.find_first_not_of("noe ") == 4 );
+        CHECK( v.find_last_not_of("noe ") == 15 );
+        CHECK( v.substr(8).find("two") == 6 );
+        CHECK( v.find("four") == tinystd::string_view::npos );
+    }
+
+    SECTION("Strings and views") {
+        tinystd::string s("first,second,third");
+
+        // Strings convert to views of their own characters
+        tinystd::string_view v = s;
+        CHECK( v.data() == s.c_str() );
+        CHECK( v.size() == s.size() );
+        CHECK( s == v );
+        CHECK( v == s );
+        CHECK( s.view().substr(6, 6) == "second" );
+
+        tinystd::string_view field = v.substr(13);
+        tinystd::string t(field);
+        CHECK( t == "third" );
+
+        t.append(tinystd::string_view(",fourth"));
+        t += tinystd::string_view("!");
+        CHECK( t == "third,fourth!" );
+        t.insert(0, tinystd::string_view("zero,"));
+        CHECK( t == "zero,third,fourth!" );
+        t.assign(v.substr(0, 5));
+        CHECK( t == "first" );
+        t = v.substr(6, 6);
+        CHECK( t == "second" );
+
+        CHECK( s.find(tinystd::string_view("second")) == 6 );
+        CHECK( s.find_last_of(tinystd::string_view(",")) == 12 );
+        CHECK( s.compare("first,second,third") == 0 );
+        CHECK( s.compare(0, 5, v.substr(0, 5)) == 0 );
+        CHECK( s.compare(tinystd::string("g")) < 0 );
+
+        tinystd::string sub = s.substr(6, 6);
+        CHECK( sub == "second" );
+        CHECK( s.substr(13) == "third" );
+        CHECK( s.substr(100).empty() );
+    }
+
+    SECTION("Character types") {
+        tinystd::wstring w(L"wide string");
+        tinystd::wstring_view wv = w;
+        CHECK( wv.substr(5) == L"string" );
+        CHECK( wv.find(L"str") == 5 );
+
+        tinystd::u32string_view u(U"abc");
+        CHECK( u.compare(U"abd") < 0 );
+    }
+}
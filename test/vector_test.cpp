@@ -10,9 +10,29 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <string>
+#include <thread>
 #include <tinystl/vector>
 #include <tinystl/string>
 
+struct alignas(64) wide_element {
+    float lanes[16];
+};
+
+struct registry_probe {
+    int value;
+};
+
+// Points into itself, so it must not be moved bitwise
+struct self_ref {
+    int value;
+    int *self;
+
+    self_ref(int v) : value(v), self(&value) {}
+    self_ref(const self_ref& o) : value(o.value), self(&value) {}
+    self_ref(self_ref&& o) : value(o.value), self(&value) {}
+};
+
 TEST_CASE("tinystl::vector class", "[tinystl::vector]") {
 
     SECTION("Constructors") {
@@ -223,6 +243,27 @@ TEST_CASE("tinystl::vector class", "[tinystl::vector]") {
             }
         }
 
+        SECTION("insert non-relocatable") {
+            // std::string may point into itself, so elements must be moved, not memmoved
+            tinystd::vector<std::string> vec;
+            vec.push_back("a");
+            vec.push_back("b");
+            vec.push_back("c");
+
+            vec.insert(vec.begin(), std::string("z"));
+            vec.insert(vec.begin() + 2, 2, std::string("a string too long for the local buffer"));
+            std::string arr[] = { "x", "y" };
+            vec.insert(vec.end() - 1, arr, arr + 2);
+            vec.insert(vec.begin(), { std::string("p"), std::string("q"), std::string("r"), std::string("s") });
+
+            const char *expected[] = { "p", "q", "r", "s", "z", "a", "a string too long for the local buffer",
+                                       "a string too long for the local buffer", "b", "x", "y", "c" };
+            REQUIRE( vec.size() == 12 );
+            for (int i=0; i < 12; i++) {
+                CHECK( vec[i] == expected[i] );
+            }
+        }
+
         SECTION("erase") {
             tinystd::vector<int> c{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
             c.erase(c.begin());
@@ -287,12 +328,179 @@ TEST_CASE("tinystl::vector class", "[tinystl::vector]") {
             CHECK( (c[0] == 1 && c[1] == 2 && c[2] == 3) );
             c.resize(5);
             CHECK( c.size() == 5 );
-            CHECK( (c[0] == 1 && c[1] == 2 && c[2] == 3 && c[4] == 0 && c[5] == 0) );
+            CHECK( (c[0] == 1 && c[1] == 2 && c[2] == 3 && c[3] == 0 && c[4] == 0) );
             c.resize(2);
             CHECK( c.size() == 2 );
             CHECK( (c[0] == 1 && c[1] == 2) );
         }
 
+        SECTION("alignment") {
+            tinystd::vector<wide_element> wide;
+            for (int i=0; i < 5; i++) {
+                wide.push_back(wide_element());
+                CHECK( ((uintptr_t)wide.data() & 63) == 0 );
+            }
+
+            tinystd::vector<float> floats;
+            floats.reserve(TINYSTD_CACHELINE_ARRAY / sizeof(float));
+            CHECK( ((uintptr_t)floats.data() & (TINYSTD_CACHELINE - 1)) == 0 );
+
+            // Small arrays stay with the plain alignment and can be resized with realloc
+            tinystd::allocator<int> a;
+            CHECK( a.alignment(100 * sizeof(int)) == alignof(int) );
+            int *p = a.allocate(100);
+            for (int i=0; i < 100; i++) p[i] = i;
+            int *q = a.reallocate(p, 100, 200);
+            if (q) {
+                CHECK( q[99] == 99 );
+                a.deallocate(q, 200);
+            }
+            else
+                a.deallocate(p, 100);
+
+            tinystd::vector<double, tinystd::allocator<double, tinystd::default_policy, 128> > doubles(3, 1.0);
+            CHECK( ((uintptr_t)doubles.data() & 127) == 0 );
+            CHECK( doubles[2] == 1.0 );
+        }
+
+        SECTION("large buffers") {
+            const int count = TINYSTD_MMAP_THRESHOLD / sizeof(int);
+            tinystd::vector<int> v;
+            v.reserve(count);
+            CHECK( ((uintptr_t)v.data() & 4095) == 0 );
+
+            for (int i=0; i < count; i++) v.push_back(i);
+            // Grows the mapping
+            v.push_back(count);
+
+            CHECK( v.size() == (size_t)count + 1 );
+            CHECK( v.capacity() >= 2 * (size_t)count );
+            bool ok = true;
+            for (int i=0; i <= count; i++) {
+                if (v[i] != i) ok = false;
+            }
+            CHECK( ok );
+        }
+
+        SECTION("in-place growth") {
+            tinystd::allocator<int> a;
+            int *p = a.allocate(40);
+            for (int i=0; i < 40; i++) p[i] = i;
+
+            CHECK( a.try_expand(p, 40, 40) );
+            CHECK_FALSE( a.try_expand(p, 40, 20) );
+
+            int *q = a.reallocate(p, 40, 4000);
+            if (q) {
+                bool ok = true;
+                for (int i=0; i < 40; i++) {
+                    if (q[i] != i) ok = false;
+                }
+                CHECK( ok );
+                a.deallocate(q, 4000);
+            }
+            else
+                a.deallocate(p, 40);
+
+            tinystd::vector<self_ref> v;
+            for (int i=0; i < 1000; i++) v.push_back(self_ref(i));
+            bool ok = true;
+            for (int i=0; i < 1000; i++) {
+                if (v[i].value != i || v[i].self != &v[i].value) ok = false;
+            }
+            CHECK( ok );
+        }
+
+        SECTION("runtime backend") {
+            // The test is also run with TINYSTD_ALLOC set, see test/CMakeLists.txt
+            const char *env = getenv("TINYSTD_ALLOC");
+            tinystd::vector<int, tinystd::allocator<int, tinystd::runtime_policy> > v;
+            for (int i=0; i < 1000; i++) v.push_back(i);
+            v.reserve(5000);
+
+            bool ok = true;
+            for (int i=0; i < 1000; i++) {
+                if (v[i] != i) ok = false;
+            }
+            CHECK( ok );
+            CHECK( strcmp(alloc_backend_get()->name, env ? env : "libc") == 0 );
+        }
+
+#if TINYSTD_ALLOCATOR_POLICY != TINYSTD_POLICY_FAST && TINYSTD_ALLOCATOR_POLICY != TINYSTD_POLICY_RUNTIME && !TINYSTD_ALLOCATOR_CACHE && TINYSTD_MEMORY_STATS
+        SECTION("memory statistics") {
+            tinystd::memory_statistics before = tinystd::memory_stats();
+            {
+                tinystd::vector<int> v;
+                v.reserve(1000);
+
+                tinystd::memory_statistics during = tinystd::memory_stats();
+                CHECK( during.allocs == before.allocs + 1 );
+                CHECK( during.live_bytes >= before.live_bytes + 1000 * sizeof(int) );
+                CHECK( during.peak_bytes >= during.live_bytes );
+                CHECK( during.size_classes[12] == before.size_classes[12] + 1 );
+            }
+            tinystd::memory_statistics after = tinystd::memory_stats();
+            CHECK( after.frees == before.frees + 1 );
+            CHECK( after.live_bytes == before.live_bytes );
+
+            // Other threads publish their counts when they exit at the latest
+            std::thread t([]() {
+                tinystd::vector<int> w;
+                w.reserve(1000);
+            });
+            t.join();
+            tinystd::memory_statistics joined = tinystd::memory_stats();
+            CHECK( joined.allocs == after.allocs + 1 );
+            CHECK( joined.frees == after.frees + 1 );
+            CHECK( joined.live_bytes == after.live_bytes );
+            CHECK( joined.peak_bytes >= after.live_bytes + 1000 * sizeof(int) );
+        }
+#endif
+
+#if TINYSTD_ALLOCATION_REGISTRY && TINYSTD_ALLOCATOR_POLICY != TINYSTD_POLICY_RUNTIME
+        SECTION("live allocation registry") {
+            tinystd::vector<registry_probe> v;
+            v.reserve(10);
+
+            FILE *f = tmpfile();
+            tinystd::dump_live_allocations(f);
+            rewind(f);
+            char line[256];
+            bool found = false;
+            while (fgets(line, sizeof(line), f)) {
+                if (strstr(line, "registry_probe"))
+                    found = true;
+            }
+            fclose(f);
+
+            CHECK( found );
+        }
+#endif
+
+#if TINYSTD_ALLOCATION_SAMPLING
+        SECTION("allocation sampling") {
+            tinystd::start_allocation_sampling(1);
+            {
+                tinystd::vector<registry_probe> v;
+                v.reserve(10);
+            }
+            tinystd::stop_allocation_sampling();
+
+            FILE *f = tmpfile();
+            tinystd::dump_allocation_samples(f, tinystd::SAMPLES_FOLDED);
+            rewind(f);
+            char line[4096];
+            bool found = false;
+            while (fgets(line, sizeof(line), f)) {
+                if (strstr(line, "[registry_probe]"))
+                    found = true;
+            }
+            fclose(f);
+
+            CHECK( found );
+        }
+#endif
+
         SECTION("swap") {
             tinystd::vector<int> v1{1, 2, 3};
             tinystd::vector<int> v2{7, 8, 9};